@@ -56,7 +56,20 @@ class ControlWorker:
         # I tuned these thresholds based on the sensor calibration data to minimize false positives from sensor noise.
         self.water_danger_threshold = 70.0    # Water level % for DANGER
         self.water_warning_threshold = 40.0   # Water level % for WARNING
+        self.water_eta_warning_seconds = 600  # Warn when the controller predicts DANGER within this
         self.tilt_threshold = 30.0            # Degrees for structural alert
+        self.quake_rms_threshold = 0.1        # m/s^2 of 1-10 Hz shaking (controller spectrum)
+        self.intensity_warning_level = 5      # MMI V: felt by nearly everyone
+        self.intensity_danger_level = 6       # MMI VI: felt by all, light damage
+        self.intensity_danger_hold_seconds = 2.0  # Two 1 s buckets; one knock is a single bucket
+        self.intensity_danger_since: Optional[float] = None
+        self.intensity_danger_reason = ""
+        
+        # Latest controller vibration spectrum; a recent non-quake verdict
+        # vetoes gyro spike alerts (footfall, doors)
+        self.last_vibration: Optional[dict] = None
+        self.last_vibration_time = 0.0
+        self.vibration_veto_seconds = 5.0
         
         # Hazard classes that trigger immediate DANGER
         self.critical_hazards = ["Fire", "Explosion", "Flood", "Collapsed Structure"]
@@ -95,6 +108,16 @@ class ControlWorker:
             self._handle_detection(data)
         elif event_type == "sensor_update":
             self._handle_sensor(data)
+        elif event_type == "device_rule":
+            self._handle_device_rule(data)
+        elif event_type == "device_link_restored":
+            self._handle_link_restored(data)
+        elif event_type == "device_vibration":
+            self._handle_vibration(data)
+        elif event_type == "device_intensity":
+            self._handle_intensity(data)
+        elif event_type == "device_water_trend":
+            self._handle_water_trend(data)
     
     def _handle_detection(self, data: dict):
         """Process AI detection and trigger alerts"""
@@ -121,6 +144,8 @@ class ControlWorker:
         current_alert = state.get_alert()["value"]
         
         # Check water level (now raining)
+        self._confirm_intensity_danger()
+        
         if raining >= self.water_danger_threshold:
             if current_alert < AlertState.DANGER:
                 self._trigger_alert(AlertState.DANGER, f"Precipitation level critical: {raining:.1f}%")
@@ -128,12 +153,103 @@ class ControlWorker:
             if current_alert < AlertState.CALLING:
                 self._trigger_alert(AlertState.CALLING, f"Showers detected: {raining:.1f}%")
         
-        # Check tilt (now earthquake monitor)
+        # Check tilt (now earthquake monitor). When the controller's spectrum
+        # says the current shaking is impulsive, the spike is not a quake.
         tilt_magnitude = abs(earthquake.get("x", 0)) + abs(earthquake.get("y", 0))
-        if tilt_magnitude > self.tilt_threshold:
+        if tilt_magnitude > self.tilt_threshold and not self._recent_impulsive():
             if current_alert < AlertState.CALLING:
                 self._trigger_alert(AlertState.CALLING, f"Ground vibration detected: {tilt_magnitude:.1f}°")
     
+    def _handle_water_trend(self, data: dict):
+        """Controller rate-of-rise estimate: warn before the water gets high"""
+        eta = data.get("eta_s")
+        if not data.get("rising") or eta is None or eta > self.water_eta_warning_seconds:
+            return
+        if state.get_alert()["value"] < AlertState.CALLING:
+            self._trigger_alert(AlertState.CALLING,
+                                f"Water rising {data.get('rate', 0):.1f}%/min, "
+                                f"danger level in ~{eta / 60:.0f} min")
+    
+    def _recent_impulsive(self) -> bool:
+        """True while the latest controller spectrum says the shaking is not a quake"""
+        return (self.last_vibration is not None
+                and not self.last_vibration.get("quake", False)
+                and time.time() - self.last_vibration_time < self.vibration_veto_seconds)
+    
+    def _handle_intensity(self, data: dict):
+        """Controller intensity level change (MMI from PGA/PGV)"""
+        level = data.get("level", 1)
+        current_alert = state.get_alert()["value"]
+        reason = (f"Shaking intensity MMI {data.get('mmi', 0):.1f} "
+                  f"(PGA {data.get('pga', 0):.0f} cm/s^2, PGV {data.get('pgv', 0):.1f} cm/s)")
+        if level >= self.intensity_danger_level:
+            # Level events only come on change: held here and confirmed from
+            # the periodic sensor updates once it has lasted
+            if self.intensity_danger_since is None:
+                self.intensity_danger_since = time.time()
+            self.intensity_danger_reason = reason
+            self._confirm_intensity_danger()
+            return
+        self.intensity_danger_since = None
+        if level >= self.intensity_warning_level and not self._recent_impulsive():
+            # Strong single impacts (doors, drops) reach V on PGA alone
+            if current_alert < AlertState.CALLING:
+                self._trigger_alert(AlertState.CALLING, reason)
+    
+    def _confirm_intensity_danger(self):
+        """DANGER from intensity only once it held and the shaking is not impulsive"""
+        if self.intensity_danger_since is None:
+            return
+        if time.time() - self.intensity_danger_since < self.intensity_danger_hold_seconds:
+            return
+        if self._recent_impulsive():
+            # A dropped or knocked unit; a real quake turns the spectrum back
+            return
+        self.intensity_danger_since = None
+        if state.get_alert()["value"] < AlertState.DANGER:
+            self._trigger_alert(AlertState.DANGER, self.intensity_danger_reason)
+    
+    def _handle_vibration(self, data: dict):
+        """Controller spectrum: alert only on sustained 1-10 Hz shaking"""
+        self.last_vibration = data
+        self.last_vibration_time = time.time()
+        quake_rms = data.get("bands", {}).get("quake", 0)
+        if data.get("quake") and quake_rms >= self.quake_rms_threshold:
+            if state.get_alert()["value"] < AlertState.CALLING:
+                self._trigger_alert(AlertState.CALLING,
+                                    f"Ground shaking: {quake_rms:.2f} m/s^2 at {data.get('dom_hz', 0):.1f} Hz")
+    
+    def _handle_device_rule(self, data: dict):
+        """Sync backend state after the controller escalated on its own"""
+        alert = AlertState(data.get("alert", 0))
+        if state.get_alert()["value"] < alert:
+            self._trigger_alert(alert, f"Device rule {data.get('rule')}: value {data.get('value')}")
+    
+    def _handle_link_restored(self, data: dict):
+        """Adopt any alert the controller raised on its own while we were away"""
+        alert = AlertState(data.get("alert", 0))
+        if state.get_alert()["value"] < alert:
+            self._trigger_alert(alert, f"Device failsafe during {data.get('outage_ms', 0) / 1000:.0f}s link outage")
+        # Rules may have been lost with the link (e.g. device reboot)
+        self._sync_device_rules()
+    
+    def _sync_device_rules(self):
+        """Push the thresholds above to the controller's on-device rules engine"""
+        if not self.sensor_worker:
+            return
+        # [channel, op, threshold, hysteresis, hold_ms, alert] - see firmware rules_engine.h
+        # CH_MMI is per 1 s bucket: the hold needs two buckets over the level
+        CH_WATER, CH_VIB_QUAKE, CH_MMI, CH_WATER_ETA = 0, 9, 11, 13
+        RULE_ABOVE, RULE_BELOW = 0, 1
+        rules = [
+            [CH_WATER, RULE_ABOVE, self.water_danger_threshold, 5.0, 500, int(AlertState.DANGER)],
+            [CH_WATER, RULE_ABOVE, self.water_warning_threshold, 5.0, 1000, int(AlertState.CALLING)],
+            [CH_VIB_QUAKE, RULE_ABOVE, self.quake_rms_threshold, 0.03, 0, int(AlertState.CALLING)],
+            [CH_MMI, RULE_ABOVE, self.intensity_danger_level - 0.5, 0.5, 2000, int(AlertState.DANGER)],
+            [CH_WATER_ETA, RULE_BELOW, self.water_eta_warning_seconds, 60, 5000, int(AlertState.CALLING)],
+        ]
+        self.sensor_worker.send_command({"cmd": "rules_set", "rules": rules})
+    
     def _trigger_alert(self, alert_state: AlertState, reason: str):
         """Trigger an alert (Vocal/GUI only, doesn't call automatically)"""
         now = time.time()
@@ -149,6 +265,10 @@ class ControlWorker:
         # Send command to ESP32 for LED visual only
         self._send_led_command(alert_state)
         
+        # Freeze the controller's full-rate sample window around the event
+        if alert_state >= AlertState.DANGER and self.sensor_worker:
+            self.sensor_worker.request_recording()
+        
         # BROADCAST: 'HAZARD_DETECTED' for UI notification
         state._emit("hazard_detected", {"type": alert_state.name, "reason": reason})
         
@@ -350,6 +470,9 @@ class ControlWorker:
         self.thread = threading.Thread(target=self._control_loop, daemon=True)
         self.thread.start()
         
+        # Keep the controller's local rules in step with our thresholds
+        self._sync_device_rules()
+        
         # Initial connectivity check
         self.internet_available = self._check_internet_connectivity()
         print(f"[Control] Started. Internet: {'available' if self.internet_available else 'offline (local mode)'}")
@@ -60,7 +60,27 @@ def init_db():
             reason TEXT
         )
     ''')
-    
+
+    # Windowed sensor summaries from the main controller ("agg" records),
+    # one row per channel per window
+    cursor.execute('''
+        CREATE TABLE IF NOT EXISTS sensor_aggregates (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,
+            device_id TEXT,
+            device_ts INTEGER,
+            window_ms INTEGER,
+            samples INTEGER,
+            channel TEXT,
+            min REAL,
+            max REAL,
+            mean REAL,
+            rms REAL,
+            p2p REAL
+        )
+    ''')
+    cursor.execute("CREATE INDEX IF NOT EXISTS idx_sensor_aggregates_channel ON sensor_aggregates (channel, timestamp)")
+
     conn.commit()
     conn.close()
 
@@ -90,6 +110,25 @@ def log_alert(state: str, reason: str):
     except Exception as e:
         print(f"[DB] Alert log error: {e}")
 
+def log_sensor_aggregate(device_id: str, record: Dict):
+    try:
+        rows = [
+            (device_id, record.get("ts"), record.get("window_ms"), record.get("n"), name,
+             s.get("min"), s.get("max"), s.get("mean"), s.get("rms"), s.get("p2p"))
+            for name, s in record.get("ch", {}).items()
+        ]
+        conn = sqlite3.connect(DB_PATH)
+        cursor = conn.cursor()
+        cursor.executemany(
+            "INSERT INTO sensor_aggregates (device_id, device_ts, window_ms, samples, channel, "
+            "min, max, mean, rms, p2p) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+            rows
+        )
+        conn.commit()
+        conn.close()
+    except Exception as e:
+        print(f"[DB] Sensor aggregate log error: {e}")
+
 def get_history(limit: int = 100):
     try:
         conn = sqlite3.connect(DB_PATH)
@@ -0,0 +1,110 @@
+"""
+MOD-EVAC-MS - Camera Push Receiver
+Reader for frames pushed by the ESP32-CAM (push_client), plus a small
+standalone receiver for testing a camera without the full backend.
+
+Wire format, one message per frame (big-endian lengths):
+    [u32 meta_len][meta][u32 jpeg_len][jpeg]
+meta is "X-Name: value\\r\\n" lines, the same headers an MJPEG part of
+/stream carries. The first message is a hello with X-Device and no JPEG.
+
+    python push_receiver.py --port 5558 --save frames/
+"""
+
+import argparse
+import os
+import socket
+import struct
+import threading
+import time
+
+PUSH_PORT = 5558
+MAX_META = 4096
+MAX_JPEG = 1 << 20
+
+
+def _recv_exact(sock: socket.socket, n: int) -> bytes:
+    buf = bytearray()
+    while len(buf) < n:
+        chunk = sock.recv(n - len(buf))
+        if not chunk:
+            raise ConnectionError("camera closed the connection")
+        buf.extend(chunk)
+    return bytes(buf)
+
+
+def read_push_messages(sock: socket.socket):
+    """Yield (headers, jpeg_bytes) per message; jpeg_bytes is b"" for the hello"""
+    while True:
+        (meta_len,) = struct.unpack(">I", _recv_exact(sock, 4))
+        if meta_len > MAX_META:
+            raise ValueError(f"meta length {meta_len} out of range")
+        meta = _recv_exact(sock, meta_len).decode("latin-1")
+        (jpeg_len,) = struct.unpack(">I", _recv_exact(sock, 4))
+        if jpeg_len > MAX_JPEG:
+            raise ValueError(f"jpeg length {jpeg_len} out of range")
+        data = _recv_exact(sock, jpeg_len) if jpeg_len else b""
+
+        headers = {}
+        for line in meta.split("\r\n"):
+            key, sep, value = line.partition(":")
+            if sep:
+                headers[key.strip().lower()] = value.strip()
+        yield headers, data
+
+
+def serve(port: int, on_connection, host: str = "0.0.0.0"):
+    """Accept camera connections forever, one thread each: on_connection(sock, addr)"""
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((host, port))
+    server.listen(8)
+    while True:
+        sock, addr = server.accept()
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        threading.Thread(target=on_connection, args=(sock, addr), daemon=True).start()
+
+
+def _print_connection(sock: socket.socket, addr, save_dir: str = None):
+    device = f"{addr[0]}:{addr[1]}"
+    total, frames, bytes_in, window_start = 0, 0, 0, time.time()
+    try:
+        for headers, data in read_push_messages(sock):
+            if not data:
+                device = headers.get("x-device", device)
+                print(f"[PushReceiver] {device} connected from {addr[0]}")
+                continue
+            total += 1
+            frames += 1
+            bytes_in += len(data)
+            if save_dir:
+                with open(os.path.join(save_dir, f"{device}_{total:06d}.jpg"), "wb") as f:
+                    f.write(data)
+            now = time.time()
+            if now - window_start >= 1.0:
+                print(f"[PushReceiver] {device}: {frames / (now - window_start):.1f} fps, "
+                      f"{bytes_in / 1024 / (now - window_start):.0f} KB/s, "
+                      f"{headers.get('x-framesize', '?')} q{headers.get('x-quality', '?')} "
+                      f"motion {headers.get('x-motion', '?')} fire {headers.get('x-fire', '?')} "
+                      f"smoke {headers.get('x-smoke', '?')} seq {headers.get('x-seq', '?')} "
+                      f"age {headers.get('x-age-ms', '?')}ms")
+                frames, bytes_in, window_start = 0, 0, now
+    except (ConnectionError, ValueError, OSError) as e:
+        print(f"[PushReceiver] {device} disconnected: {e}")
+    finally:
+        sock.close()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="ESP32-CAM push receiver (testing)")
+    parser.add_argument("--port", type=int, default=PUSH_PORT, help="Listen port")
+    parser.add_argument("--save", type=str, help="Directory to write received JPEGs to")
+    args = parser.parse_args()
+
+    if args.save:
+        os.makedirs(args.save, exist_ok=True)
+    print(f"[PushReceiver] Listening on {args.port}... Press Ctrl+C to stop")
+    try:
+        serve(args.port, lambda sock, addr: _print_connection(sock, addr, args.save))
+    except KeyboardInterrupt:
+        print()
@@ -11,8 +11,11 @@ import json
 import threading
 import time
 import argparse
+import base64
+import os
 from typing import Optional
 from state_manager import state, AlertState
+from database import log_sensor_aggregate
 
 
 class SensorWorker:
@@ -29,6 +32,19 @@ class SensorWorker:
         self.thread: Optional[threading.Thread] = None
         self.device_id = "esp32_main"
         
+        # Flight recorder windows being reassembled, keyed by event id
+        self.recordings = {}
+        self.recordings_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "recordings")
+        
+        # Open raw stream captures (.mevc), keyed by session id
+        self.captures = {}
+        
+        # Latest firmware runtime stats record (task load, stack, jitter, heap)
+        self.last_stats: Optional[dict] = None
+        
+        # Latest windowed channel summary ("agg" record)
+        self.last_aggregate: Optional[dict] = None
+        
         # Auto-detect port if not specified
         if not self.port:
             self.port = self._find_esp32_port()
@@ -84,6 +100,10 @@ class SensorWorker:
             print(f"[SensorWorker] Send error: {e}")
             return False
     
+    def set_stats_window(self, window_ms: int) -> bool:
+        """Set the on-device aggregation window (persisted in NVS)"""
+        return self.send_command({"cmd": "stats_config", "window_ms": int(window_ms)})
+    
     def set_alert(self, alert: AlertState) -> bool:
         """Send alert command to ESP32"""
         return self.send_command({"cmd": "set_alert", "alert": int(alert)})
@@ -112,6 +132,89 @@ class SensorWorker:
             elif data.get("event") == "alert_set":
                 print(f"[SensorWorker] Alert set to: {data.get('alert')}")
                 
+            elif data.get("type") == "stats":
+                self.last_stats = data
+                misses = data.get("sensor", {}).get("misses", 0)
+                if misses:
+                    print(f"[SensorWorker] ESP32 sensor loop missed {misses} deadlines")
+                
+            elif data.get("event") == "rule_fired":
+                # The controller already switched its LEDs; let the control worker catch up
+                print(f"[SensorWorker] On-device rule {data.get('rule')} fired: alert={data.get('alert')}")
+                state._emit("device_rule", data)
+                
+            elif data.get("event") == "rules_set":
+                print(f"[SensorWorker] On-device rules loaded: {data.get('count')}")
+                
+            elif data.get("event") == "link_restored":
+                print(f"[SensorWorker] ESP32 was in failsafe for {data.get('outage_ms')}ms "
+                      f"(detected after {data.get('detect_ms')}ms, max alert {data.get('max_alert')})")
+                state._emit("device_link_restored", data)
+
+            elif data.get("type") == "agg":
+                # Windowed min/max/mean/RMS per channel, kept for trending
+                self.last_aggregate = data
+                log_sensor_aggregate(self.device_id, data)
+                
+            elif data.get("type") == "vibration":
+                # Spectrum of the current shaking; the control worker tells
+                # quakes from footfall with it
+                state._emit("device_vibration", data)
+                
+            elif data.get("event") == "intensity":
+                # Instrumental intensity (MMI) from on-device PGA/PGV
+                print(f"[SensorWorker] Shaking intensity {data.get('prev')} -> {data.get('level')} "
+                      f"(MMI {data.get('mmi', 0):.1f}, PGA {data.get('pga', 0):.1f} cm/s^2)")
+                state._emit("device_intensity", data)
+                
+            elif data.get("type") == "water_trend":
+                # Rolling slope of the water level and time left to the danger threshold
+                state._emit("device_water_trend", data)
+                
+            elif data.get("event") == "stats_config":
+                print(f"[SensorWorker] On-device stats window: {data.get('window_ms')}ms")
+                
+            elif data.get("event") == "sensor_lost":
+                # Readings from this component are held at their last value until restored
+                print(f"[SensorWorker] ESP32 lost {data.get('component')} "
+                      f"after {data.get('errors')} I2C errors, re-probing in background")
+                state._emit("device_sensor_lost", data)
+
+            elif data.get("event") == "sensor_restored":
+                print(f"[SensorWorker] ESP32 {data.get('component')} restored "
+                      f"after {data.get('probes')} probes")
+                state._emit("device_sensor_restored", data)
+
+            elif data.get("type") == "rec_chunk":
+                rec = self.recordings.get(data.get("id"))
+                if rec is not None:
+                    rec["chunks"][data.get("seq", 0)] = base64.b64decode(data.get("data", ""))
+                
+            elif data.get("event") == "rec_frozen":
+                print(f"[SensorWorker] Flight recorder frozen: id={data.get('id')} "
+                      f"samples={data.get('samples')} source={data.get('source')}")
+                self.recordings[data.get("id")] = {"header": data, "chunks": {}}
+                
+            elif data.get("event") == "rec_done":
+                self._save_recording(data.get("id"), data.get("chunks", 0))
+                
+            elif data.get("type") == "cap_header":
+                self._open_capture(data.get("session"), base64.b64decode(data.get("data", "")))
+                
+            elif data.get("type") == "cap_block":
+                f = self.captures.get(data.get("session"))
+                if f is not None:
+                    # Append-only: every block is self-contained, so a crash leaves a valid file
+                    f.write(base64.b64decode(data.get("data", "")))
+                    f.flush()
+                
+            elif data.get("event") == "cap_done":
+                f = self.captures.pop(data.get("session"), None)
+                if f is not None:
+                    f.close()
+                    print(f"[SensorWorker] Capture saved: {f.name} "
+                          f"({data.get('blocks')} blocks, {data.get('dropped')} dropped on device)")
+                
             elif data.get("event") == "pong":
                 print(f"[SensorWorker] ESP32 uptime: {data.get('uptime')}ms")
                 
@@ -120,6 +223,49 @@ class SensorWorker:
             if line.strip():
                 print(f"[SensorWorker] Raw: {line.strip()}")
     
+    def _save_recording(self, rec_id, expected_chunks: int):
+        """Write a reassembled flight recorder window to disk (raw samples + JSON header)"""
+        rec = self.recordings.pop(rec_id, None)
+        if rec is None:
+            return
+        
+        chunks = rec["chunks"]
+        missing = [i for i in range(expected_chunks) if i not in chunks]
+        header = dict(rec["header"])
+        header["missing_chunks"] = missing
+        
+        os.makedirs(self.recordings_dir, exist_ok=True)
+        stem = os.path.join(self.recordings_dir, f"{self.device_id}_{int(time.time())}_{rec_id}")
+        with open(stem + ".bin", "wb") as f:
+            for i in sorted(chunks):
+                f.write(chunks[i])
+        with open(stem + ".json", "w") as f:
+            json.dump(header, f)
+        
+        print(f"[SensorWorker] Flight recording saved: {stem}.bin "
+              f"({len(chunks)}/{expected_chunks} chunks)")
+    
+    def _open_capture(self, session, header: bytes):
+        """Start a .mevc file for a capture session (see firmware capture_format.h)"""
+        os.makedirs(self.recordings_dir, exist_ok=True)
+        path = os.path.join(self.recordings_dir, f"{self.device_id}_{int(time.time())}_s{session}.mevc")
+        f = open(path, "wb")
+        f.write(header)
+        f.flush()
+        self.captures[session] = f
+        print(f"[SensorWorker] Capturing raw sensor stream to {path}")
+    
+    def start_capture(self) -> bool:
+        """Stream every raw sensor sample from the controller until stop_capture()"""
+        return self.send_command({"cmd": "capture_start"})
+    
+    def stop_capture(self) -> bool:
+        return self.send_command({"cmd": "capture_stop"})
+    
+    def request_recording(self) -> bool:
+        """Ask the controller to freeze its pre/post-trigger sample window"""
+        return self.send_command({"cmd": "rec_trigger"})
+    
     def _read_loop(self):
         """Main read loop (runs in thread)"""
         buffer = ""
@@ -187,13 +333,19 @@ def init_sensor_worker(port: str = None) -> SensorWorker:
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="ESP32 Sensor Worker")
     parser.add_argument("--port", type=str, help="Serial port (e.g., COM3)")
+    parser.add_argument("--capture", action="store_true", help="Record the raw sensor stream to recordings/*.mevc")
     args = parser.parse_args()
     
     worker = init_sensor_worker(port=args.port)
+    if args.capture:
+        worker.start_capture()
     
     try:
         print("[SensorWorker] Running... Press Ctrl+C to stop")
         while True:
             time.sleep(1)
     except KeyboardInterrupt:
+        if args.capture:
+            worker.stop_capture()
+            time.sleep(1)  # Let the final block and cap_done arrive
         worker.stop()
@@ -5,11 +5,14 @@ ESP32-CAM frame reader and YOLO inference pipeline
 Reads JPEG frames from serial, runs YOLOv8 inference, publishes detections.
 """
 
+import os
 import serial
 import serial.tools.list_ports
 import threading
 import time
 import argparse
+import urllib.parse
+import urllib.request
 import cv2
 import numpy as np
 from typing import Optional, Callable
@@ -17,6 +20,65 @@ from ultralytics import YOLO
 import zmq
 
 from state_manager import state
+from push_receiver import PUSH_PORT, read_push_messages, serve as serve_push
+
+# Camera pre-filter likelihood (X-Fire / X-Smoke, 0-100) at which a frame
+# skips offloading and goes straight to local inference
+HAZARD_FAST_PATH = 50
+
+# Fire/Smoke detections pull the camera's pre-event ring (event_ring.h)
+# into recordings/clips, at most once per camera per cooldown
+CLIP_COOLDOWN_S = 60
+CLIP_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "recordings", "clips")
+
+
+def read_mjpeg_parts(source: str, timeout: float = 10.0):
+    """
+    Yield (headers, jpeg_bytes) for each part of an ESP32-CAM /stream.
+    cv2.VideoCapture hides the part headers, which carry the camera's
+    per-frame metadata.
+    """
+    with urllib.request.urlopen(source, timeout=timeout) as resp:
+        while True:
+            headers = {}
+            line = resp.readline()
+            if not line:
+                return
+            line = line.strip()
+            if not line.startswith(b"--"):
+                continue                    # Trailer CRLF or preamble
+            while True:
+                line = resp.readline()
+                if not line:
+                    return
+                line = line.strip()
+                if not line:
+                    break
+                key, _, value = line.decode("latin-1").partition(":")
+                headers[key.strip().lower()] = value.strip()
+            length = int(headers.get("content-length", 0))
+            if length <= 0:
+                continue
+            data = resp.read(length)
+            if len(data) < length:
+                return
+            yield headers, data
+
+
+def parse_model_geometry(headers: dict) -> Optional[dict]:
+    """
+    Camera model-ready mode (X-Model-*): the frame is already sized for a
+    size x size model input and needs at most a constant border of
+    pad (x, y) on each side. src is the sensor region shown, in UXGA pixels.
+    """
+    if "x-model-size" not in headers:
+        return None
+    try:
+        pad = [int(v) for v in headers.get("x-model-pad", "0,0").split(",")]
+        src = [int(v) for v in headers.get("x-model-src", "").split(",") if v]
+        return {"size": int(headers["x-model-size"]), "pad": (pad[0], pad[1]), "src": src}
+    except (ValueError, IndexError):
+        return None
 
 
 class VisionWorker:
@@ -44,7 +106,11 @@ class VisionWorker:
         self.frame_count = 0
         self.frame_counter = 0 # Monotonic counter for load balancing
         self.inference_count = 0
+        self.fast_path_count = 0
+        self.camera_stats = {}  # {device_id: per-frame metadata summary, see _track_camera}
         self.last_frames = {}  # {device_id: bytes}
+        self.last_clip = {}  # {device_id: time of the last clip pull}
+        self.clip_count = 0
         self.class_names = [
             "Fire", "Smoke", "Flood", "Falling Debris",
             "Landslide", "Explosion", "Collapsed Structure", "Industrial Accident"
@@ -61,6 +127,7 @@ class VisionWorker:
         print(f"[VisionWorker] Adding camera {device_id} at {source}")
         self.streams[device_id] = {
             "source": source,
+            "host": urllib.parse.urlparse(source).hostname if source.startswith("http") else None,
             "active": True
         }
         thread = threading.Thread(target=self._camera_loop, args=(device_id,), daemon=True)
@@ -73,6 +140,9 @@ class VisionWorker:
         
         # Determine if it's Serial or Network
         is_serial = source.startswith("COM") or source.startswith("/dev/")
+        if source.startswith("http") and source.rstrip("/").endswith("/stream"):
+            self._mjpeg_loop(device_id, source)
+            return
         
         cap = None
         if not is_serial:
@@ -107,7 +177,90 @@ class VisionWorker:
 
         if cap: cap.release()
 
-    def _process_frame(self, device_id: str, frame: np.ndarray, frame_id: int) -> np.ndarray:
+    def _mjpeg_loop(self, device_id: str, source: str):
+        """ESP32-CAM stream read part by part so the camera's headers are kept"""
+        frame_count = 0
+        while self.running and self.streams[device_id]["active"]:
+            try:
+                for headers, data in read_mjpeg_parts(source):
+                    if not (self.running and self.streams[device_id]["active"]):
+                        return
+                    frame_count += 1
+                    self._handle_camera_frame(device_id, headers, data, frame_count)
+            except (OSError, ValueError) as e:
+                print(f"[VisionWorker] Stream {device_id} lost ({e}). Retrying...")
+            time.sleep(2)
+
+    def _push_connection(self, sock, addr):
+        """One camera pushing to us (push_client); the hello names it"""
+        device_id = f"esp32_cam_{addr[0]}"
+        frame_count = 0
+        try:
+            for headers, data in read_push_messages(sock):
+                if not data:
+                    device_id = headers.get("x-device", device_id)
+                    print(f"[VisionWorker] Camera {device_id} pushing from {addr[0]}")
+                    self.streams[device_id] = {"source": f"push://{addr[0]}", "host": addr[0],
+                                               "active": True}
+                    state.update_device(device_id, "esp32_cam", True, addr[0])
+                    continue
+                if not self.running:
+                    return
+                frame_count += 1
+                self._handle_camera_frame(device_id, headers, data, frame_count)
+        except (ConnectionError, ValueError, OSError) as e:
+            print(f"[VisionWorker] Push from {device_id} ended ({e})")
+        finally:
+            sock.close()
+            if device_id in self.streams:
+                self.streams[device_id]["active"] = False
+
+    def _handle_camera_frame(self, device_id: str, headers: dict, data: bytes, frame_id: int):
+        """JPEG plus camera headers, from /stream or push"""
+        received = time.time()
+        frame = cv2.imdecode(np.frombuffer(data, np.uint8), cv2.IMREAD_COLOR)
+        if frame is None:
+            return
+        hazard = max(int(headers.get("x-fire", 0)), int(headers.get("x-smoke", 0)))
+        model_geometry = parse_model_geometry(headers)
+
+        processed_frame = self._process_frame(device_id, frame, frame_id, hazard, model_geometry)
+        self._track_camera(device_id, headers, received, time.time())
+        if processed_frame is not None:
+            _, buffer = cv2.imencode('.jpg', processed_frame, [cv2.IMWRITE_JPEG_QUALITY, 70])
+            self.last_frames[device_id] = buffer.tobytes()
+
+    def _track_camera(self, device_id: str, headers: dict, received: float, done: float):
+        """
+        Drops and latency split from the camera's X-* headers: camera side
+        (capture to send start), the previous frame's send time, and our
+        decode + inference. The camera clock is its uptime, so Wi-Fi
+        transit is not measured directly.
+        """
+        try:
+            seq = int(headers["x-seq"])
+        except (KeyError, ValueError):
+            return
+        s = self.camera_stats.setdefault(device_id, {
+            "frames": 0, "dropped": 0, "gated": 0, "last_seq": None,
+            "camera_ms": 0.0, "send_ms": 0.0, "analysis_us": 0.0, "backend_ms": 0.0
+        })
+        gated = int(headers.get("x-gated", 0))
+        if s["last_seq"] is not None and seq > s["last_seq"]:
+            s["dropped"] += max(seq - s["last_seq"] - 1 - gated, 0)
+        s["gated"] += gated
+        s["last_seq"] = seq
+        s["frames"] += 1
+
+        # Smoothed like the camera's own counters
+        for key, value in (("camera_ms", float(headers.get("x-age-ms", 0))),
+                           ("send_ms", float(headers.get("x-send-ms", 0))),
+                           ("analysis_us", float(headers.get("x-analysis-us", 0))),
+                           ("backend_ms", (done - received) * 1000)):
+            s[key] += (value - s[key]) / 8
+
+    def _process_frame(self, device_id: str, frame: np.ndarray, frame_id: int,
+                       hazard: int = 0, model_geometry: Optional[dict] = None) -> np.ndarray:
         self.frame_counter += 1
         
         # 1. Distributed Delegation (Load Balancing)
@@ -120,6 +273,11 @@ class VisionWorker:
         # If we have N workers, we process 1 locally, then N remotely, then 1 locally...
         # This keeps the Main Laptop active but significantly reduces its load.
         should_offload = (worker_count > 0) and (self.frame_counter % (worker_count + 1) != 0)
+
+        # Camera pre-filter saw fire/smoke colours: no worker round trip
+        if hazard >= HAZARD_FAST_PATH:
+            should_offload = False
+            self.fast_path_count += 1
         
         if should_offload:
             # Encode frame to base64
@@ -141,12 +299,27 @@ class VisionWorker:
         else:
             # LOCAL FALLBACK: Run local YOLO
             # Either we chose to run locally, or the worker timed out
-            results = self.model(frame, verbose=False, conf=0.4)
+            pad_x, pad_y = 0, 0
+            if model_geometry:
+                # Camera framed it for the model: border only, no resize
+                pad_x, pad_y = model_geometry["pad"]
+                model_input = frame
+                if pad_x or pad_y:
+                    model_input = cv2.copyMakeBorder(frame, pad_y, pad_y, pad_x, pad_x,
+                                                     cv2.BORDER_CONSTANT, value=(114, 114, 114))
+                results = self.model(model_input, verbose=False, conf=0.4,
+                                     imgsz=model_geometry["size"])
+            else:
+                results = self.model(frame, verbose=False, conf=0.4)
             self.inference_count += 1
             
+            h, w = frame.shape[:2]
             for r in results:
                 for box in r.boxes:
                     x1, y1, x2, y2 = box.xyxy[0].tolist()
+                    if pad_x or pad_y:
+                        x1, x2 = [min(max(v - pad_x, 0), w) for v in (x1, x2)]
+                        y1, y2 = [min(max(v - pad_y, 0), h) for v in (y1, y2)]
                     conf = float(box.conf[0])
                     cls_id = int(box.cls[0])
                     cls_name = self.class_names[cls_id] if cls_id < len(self.class_names) else "Hazard"
@@ -160,6 +333,9 @@ class VisionWorker:
                     # Add to state and DB
                     state.add_detection(cls_name, conf, [x1, y1, x2, y2], frame_id)
 
+        if any(det["class"] in ("Fire", "Smoke") for det in detections_to_draw):
+            self._request_clip(device_id)
+
         # Draw visualizations
         for det in detections_to_draw:
             cls_name = det['class']
@@ -177,6 +353,34 @@ class VisionWorker:
         
         return frame
 
+    def _request_clip(self, device_id: str):
+        """Freeze the camera's pre-event ring and download it in the background"""
+        host = self.streams.get(device_id, {}).get("host")
+        now = time.time()
+        if not host or now - self.last_clip.get(device_id, 0) < CLIP_COOLDOWN_S:
+            return
+        self.last_clip[device_id] = now
+        threading.Thread(target=self._pull_clip, args=(device_id, host, now), daemon=True).start()
+
+    def _pull_clip(self, device_id: str, host: str, detected: float):
+        base = f"http://{host}:81"
+        out_dir = os.path.join(CLIP_DIR, f"{device_id}_{int(detected)}")
+        try:
+            # Freeze right away so recording stops on the detection, not on download
+            urllib.request.urlopen(urllib.request.Request(f"{base}/clip/freeze", data=b"", method="POST"),
+                                   timeout=5).close()
+            os.makedirs(out_dir, exist_ok=True)
+            frames = 0
+            for headers, data in read_mjpeg_parts(f"{base}/clip", timeout=30):
+                with open(os.path.join(out_dir, f"{headers.get('x-seq', frames)}.jpg"), "wb") as f:
+                    f.write(data)
+                frames += 1
+            self.clip_count += 1
+            print(f"[VisionWorker] Clip from {device_id}: {frames} frames in {out_dir}")
+        except (OSError, ValueError) as e:
+            # 404 on cameras without the ring (no PSRAM or ring_kb 0)
+            print(f"[VisionWorker] Clip from {device_id} failed ({e})")
+
     def start(self):
         self.running = True
         # Attempt to auto-detect serial camera (ESP32-CAM)
@@ -186,8 +390,19 @@ class VisionWorker:
             if any(x in p.description.lower() for x in ['cp210', 'ch340', 'usb serial']):
                  self.add_camera("esp32_cam_0", p.device)
                  break
+
+        # Cameras provisioned with our address push to us (push_client)
+        push_thread = threading.Thread(target=self._serve_push, daemon=True)
+        self.threads.append(push_thread)
+        push_thread.start()
         print("[VisionWorker] Running")
 
+    def _serve_push(self):
+        try:
+            serve_push(PUSH_PORT, self._push_connection)
+        except OSError as e:
+            print(f"[VisionWorker] Push ingest on port {PUSH_PORT} unavailable: {e}")
+
     def start_video(self, source: str):
         """Helper to start a video source for testing"""
         self.running = True
@@ -203,7 +418,14 @@ class VisionWorker:
         return {
             "fps": round(self.fps, 1),
             "total_frames": self.frame_count,
-            "total_detections": self.inference_count
+            "total_detections": self.inference_count,
+            "fast_path_frames": self.fast_path_count,
+            "clips": self.clip_count,
+            "cameras": {
+                device_id: {k: (round(v, 1) if isinstance(v, float) else v)
+                            for k, v in s.items() if k != "last_seq"}
+                for device_id, s in self.camera_stats.items()
+            }
         }
 
 
@@ -0,0 +1,134 @@
+"""
+MOD-EVAC-MS - ESP32-CAM Streaming Benchmark
+Achieved frame rate, throughput and camera CPU load of /stream.
+
+Flash the bench build first (per-core CPU load in /stats needs it):
+    pio run -e esp32cam_bench -t upload
+    python bench/stream_bench.py <camera-ip> --seconds 30
+
+The stream is opened with gate=0 so the motion gate does not hold frames
+back. /stats is read once before streaming to calibrate the idle rate,
+then once a second. For a fixed resolution, pin the rate control bounds
+first (e.g. framesize_min = framesize_max = 8 for VGA via /config).
+
+The on-camera analysis (one decode feeding the motion gate and the hazard
+pre-filter, in the capture task before every publish) is reported per
+frame size against the capture interval it has to fit in.
+"""
+
+import argparse
+import json
+import threading
+import time
+import urllib.request
+
+
+# esp32-camera framesize_t, as "rate.framesize" in /stats
+FRAME_SIZES = {
+    0: "96X96", 1: "QQVGA", 2: "QCIF", 3: "HQVGA", 4: "240X240", 5: "QVGA", 6: "CIF",
+    7: "HVGA", 8: "VGA", 9: "SVGA", 10: "XGA", 11: "HD", 12: "SXGA", 13: "UXGA",
+}
+
+
+def read_parts(url: str, timeout: float = 10.0):
+    """Yield (headers, jpeg_len) per MJPEG part"""
+    with urllib.request.urlopen(url, timeout=timeout) as resp:
+        while True:
+            line = resp.readline()
+            if not line:
+                return
+            if not line.strip().startswith(b"--"):
+                continue
+            headers = {}
+            while True:
+                line = resp.readline().strip()
+                if not line:
+                    break
+                key, _, value = line.decode("latin-1").partition(":")
+                headers[key.strip().lower()] = value.strip()
+            length = int(headers.get("content-length", 0))
+            if len(resp.read(length)) < length:
+                return
+            yield headers, length
+
+
+def get_stats(host: str) -> dict:
+    with urllib.request.urlopen(f"http://{host}:81/stats", timeout=5) as resp:
+        return json.loads(resp.read())
+
+
+def mean(values):
+    return sum(values) / len(values) if values else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ESP32-CAM streaming benchmark")
+    parser.add_argument("host", help="Camera IP address")
+    parser.add_argument("--seconds", type=float, default=30.0)
+    args = parser.parse_args()
+
+    # Idle calibration for cpu_load.h
+    get_stats(args.host)
+    time.sleep(1.0)
+    idle = get_stats(args.host)
+    if "cpu" not in idle:
+        print("No \"cpu\" in /stats: flash env:esp32cam_bench for CPU load")
+
+    cpu_samples = []
+    analysis = {}           # framesize -> [(analysis us, max us, capture fps)]
+    done = threading.Event()
+
+    def poll_stats():
+        while not done.wait(1.0):
+            try:
+                stats = get_stats(args.host)
+            except OSError:
+                continue
+            if stats.get("cpu"):
+                cpu_samples.append(stats["cpu"])
+            a = stats.get("analysis", {})
+            size = stats.get("rate", {}).get("framesize")
+            if "us" in a and size is not None:
+                fps = stats.get("capture", {}).get("fps", 0.0)
+                analysis.setdefault(size, []).append((a["us"], a.get("max_us", 0), fps))
+
+    poller = threading.Thread(target=poll_stats, daemon=True)
+    poller.start()
+
+    frames, total_bytes = 0, 0
+    ages, sends, sizes, qualities = [], [], set(), set()
+    start = time.time()
+    for headers, length in read_parts(f"http://{args.host}:81/stream?gate=0"):
+        if frames == 0:
+            start = time.time()         # Exclude connection setup
+        frames += 1
+        total_bytes += length
+        ages.append(float(headers.get("x-age-ms", 0)))
+        sends.append(float(headers.get("x-send-ms", 0)))
+        sizes.add(headers.get("x-framesize", "?"))
+        qualities.add(headers.get("x-quality", "?"))
+        if time.time() - start >= args.seconds:
+            break
+    elapsed = max(time.time() - start, 1e-3)
+    done.set()
+
+    print(f"frames        {frames} in {elapsed:.1f} s")
+    print(f"fps           {frames / elapsed:.1f}")
+    print(f"throughput    {total_bytes / 1024 / elapsed:.0f} KB/s")
+    print(f"frame         {total_bytes / 1024 / max(frames, 1):.1f} KB mean, "
+          f"sizes {sorted(sizes)}, quality {sorted(qualities)}")
+    print(f"camera        age {mean(ages):.1f} ms, send {mean(sends):.1f} ms (means)")
+    if cpu_samples:
+        print(f"cpu           core0 {mean([c[0] for c in cpu_samples]):.0f}%, "
+              f"core1 {mean([c[1] for c in cpu_samples]):.0f}%")
+    for size, samples in sorted(analysis.items()):
+        us = mean([s[0] for s in samples])
+        fps = mean([s[2] for s in samples])
+        interval_ms = 1000.0 / fps if fps > 0 else 0.0
+        share = f", {us / 10.0 / interval_ms:.0f}% of the {interval_ms:.0f} ms capture interval" if interval_ms else ""
+        print(f"analysis      {FRAME_SIZES.get(size, size)}: {us / 1000.0:.1f} ms/frame mean, "
+              f"worst since boot {max(s[1] for s in samples) / 1000.0:.1f} ms{share}")
+
+
+if __name__ == "__main__":
+    main()
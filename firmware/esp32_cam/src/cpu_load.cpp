@@ -0,0 +1,62 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM CPU Load (bench builds)
+ */
+
+#include "cpu_load.h"
+
+#ifdef STREAM_BENCH
+
+#include <Arduino.h>
+#include <esp_freertos_hooks.h>
+
+static volatile uint32_t idleCount[2];
+static uint32_t lastCount[2];
+static uint32_t lastMs[2];
+static float maxRate[2];
+
+static bool idleHook0() {
+    idleCount[0]++;
+    return false;               // Keep spinning so the count tracks idle time
+}
+
+static bool idleHook1() {
+    idleCount[1]++;
+    return false;
+}
+
+void cpuLoadBegin() {
+    esp_register_freertos_idle_hook_for_cpu(idleHook0, 0);
+    esp_register_freertos_idle_hook_for_cpu(idleHook1, 1);
+    lastMs[0] = lastMs[1] = millis();
+}
+
+bool cpuLoadAvailable() {
+    return true;
+}
+
+uint8_t cpuLoadPercent(uint8_t core) {
+    if (core > 1) return 0;
+    uint32_t now = millis();
+    uint32_t count = idleCount[core];
+    uint32_t elapsed = now - lastMs[core];
+    if (elapsed == 0) return 0;
+    float rate = (float)(count - lastCount[core]) / elapsed;
+    lastCount[core] = count;
+    lastMs[core] = now;
+    if (rate > maxRate[core]) maxRate[core] = rate;
+    return (maxRate[core] > 0) ? (uint8_t)(100.0f * (1.0f - rate / maxRate[core]) + 0.5f) : 0;
+}
+
+#else
+
+void cpuLoadBegin() {}
+
+bool cpuLoadAvailable() {
+    return false;
+}
+
+uint8_t cpuLoadPercent(uint8_t core) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,21 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM CPU Load (bench builds)
+ * Per-core load for the streaming benchmark (env:esp32cam_bench, which
+ * defines STREAM_BENCH). An idle hook on each core counts while the idle
+ * task runs; load is the drop of that rate below the highest rate seen,
+ * so read /stats once while nothing streams to calibrate.
+ *
+ * The hook keeps the idle task spinning instead of waiting for an
+ * interrupt, which costs power, so normal builds compile it out and
+ * cpuLoadAvailable() returns false.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+void cpuLoadBegin();
+bool cpuLoadAvailable();
+
+// Percent busy since the previous call for this core
+uint8_t cpuLoadPercent(uint8_t core);
@@ -0,0 +1,276 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Pre-event Ring
+ */
+
+#include "event_ring.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <lwip/sockets.h>
+#include "frame_hub.h"
+#include "stream_server.h"
+
+// Close-delimited: the clip task ends the body by closing the session
+static const char CLIP_HEAD[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/mixed; boundary=frame\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+static const char PART_TRAILER[] = "\r\n";
+
+// One record per frame in the byte ring: its X-* header lines and the
+// blank line ending them, then the JPEG, so a clip part is the record
+// between a head and a trailer. Records never straddle the end; the
+// unused tail is skipped.
+typedef struct {
+    uint32_t offset;
+    uint16_t metaLen;           // Including the blank line
+    uint32_t jpegLen;
+    int64_t tsUs;               // Capture time (esp_timer clock)
+} RingEntry_t;
+
+static uint8_t* ring = NULL;
+static uint32_t ringSize = 0;
+static uint32_t writePos = 0;
+static RingEntry_t entries[EVENT_RING_MAX_FRAMES];
+static uint16_t oldest = 0, count = 0;
+static uint32_t usedBytes = 0;
+
+static bool frozen = false;
+static bool sending = false;    // A clip is going out; the freeze timeout waits
+static uint32_t frozenMs = 0;
+static SemaphoreHandle_t ringMutex = NULL;
+
+static void evictOldest() {
+    usedBytes -= entries[oldest].metaLen + entries[oldest].jpegLen;
+    oldest = (oldest + 1) % EVENT_RING_MAX_FRAMES;
+    count--;
+}
+
+// Caller holds ringMutex
+static void append(const char* meta, uint16_t metaLen, const uint8_t* jpeg, uint32_t jpegLen, int64_t tsUs) {
+    uint32_t len = metaLen + jpegLen;
+    if (len > ringSize) return;
+    if (count == EVENT_RING_MAX_FRAMES) evictOldest();
+
+    if (writePos + len > ringSize) {
+        // Skipping the tail: whatever still lives there is from the
+        // previous lap and older than anything at the start
+        while (count && entries[oldest].offset >= writePos) evictOldest();
+        writePos = 0;
+    }
+    // Oldest records start at or after writePos; drop those in the way
+    while (count && entries[oldest].offset >= writePos && entries[oldest].offset < writePos + len) {
+        evictOldest();
+    }
+
+    memcpy(ring + writePos, meta, metaLen);
+    memcpy(ring + writePos + metaLen, jpeg, jpegLen);
+    RingEntry_t* e = &entries[(oldest + count) % EVENT_RING_MAX_FRAMES];
+    e->offset = writePos;
+    e->metaLen = metaLen;
+    e->jpegLen = jpegLen;
+    e->tsUs = tsUs;
+    count++;
+    usedBytes += len;
+    writePos += len;
+}
+
+// ============================================================================
+// RECORDER TASK
+// ============================================================================
+static void recorderTask(void* parameter) {
+    char meta[FRAME_HEADERS_MAX];
+    uint32_t lastSeq = 0;
+    int64_t lastUs = 0;
+    frameHubSubscribe(xTaskGetCurrentTaskHandle());
+
+    while (true) {
+        Frame_t* frame = frameHubAcquire(lastSeq, 1000);
+
+        xSemaphoreTake(ringMutex, portMAX_DELAY);
+        if (frozen && !sending && millis() - frozenMs > EVENT_RING_FREEZE_MAX_MS) frozen = false;
+        bool paused = frozen;
+        xSemaphoreGive(ringMutex);
+
+        if (!frame) continue;
+        lastSeq = frame->seq;
+        camera_fb_t* fb = frame->fb;
+        int64_t tsUs = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+        // 10% slack so capture jitter does not halve the recorded rate
+        if (paused || tsUs - lastUs < 900000 / EVENT_RING_FPS) {
+            frameHubRelease(frame);
+            continue;
+        }
+        lastUs = tsUs;
+
+        int metaLen = frameFormatHeaders(frame, 0, 0, meta, sizeof(meta) - 2);
+        memcpy(meta + metaLen, "\r\n", 2);
+        metaLen += 2;
+        xSemaphoreTake(ringMutex, portMAX_DELAY);
+        if (!frozen) append(meta, metaLen, fb->buf, fb->len, tsUs);
+        xSemaphoreGive(ringMutex);
+        frameHubRelease(frame);
+    }
+}
+
+// ============================================================================
+// HTTP HANDLERS
+// ============================================================================
+static void freeze() {
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    frozen = true;
+    frozenMs = millis();
+    xSemaphoreGive(ringMutex);
+}
+
+// A clip being sent reads the ring unlocked; it releases it when done
+static void release() {
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    if (!sending) frozen = false;
+    xSemaphoreGive(ringMutex);
+}
+
+// Download over; a failed one stays frozen for a retry (until the freeze
+// timeout)
+static void clipDone(bool ok) {
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    sending = false;
+    if (ok) {
+        frozen = false;
+    } else {
+        frozenMs = millis();
+    }
+    xSemaphoreGive(ringMutex);
+}
+
+static esp_err_t sendRingStats(httpd_req_t* req) {
+    EventRingStats_t s = eventRingStats();
+    char body[128];
+    int len = snprintf(body, sizeof(body),
+                       "{\"frozen\":%s,\"frames\":%u,\"kbytes\":%u,\"span_ms\":%u}",
+                       s.frozen ? "true" : "false", s.frames, (unsigned)(s.bytes / 1024),
+                       (unsigned)s.spanMs);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, body, len);
+}
+
+static esp_err_t handleFreeze(httpd_req_t* req) {
+    if (!ring) return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "ring disabled");
+    freeze();
+    return sendRingStats(req);
+}
+
+static esp_err_t handleRelease(httpd_req_t* req) {
+    if (!ring) return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "ring disabled");
+    release();
+    return sendRingStats(req);
+}
+
+// ============================================================================
+// CLIP TASK (one download at a time)
+// ============================================================================
+// Frozen ring, oldest first, as multipart parts; released once the whole
+// clip went out
+static void clipTask(void* arg) {
+    int fd = (int)(intptr_t)arg;
+    char head[80];
+
+    // Nothing appends while frozen, so the index can be walked unlocked
+    bool ok = true;
+    for (uint16_t i = 0; i < count && ok; i++) {
+        const RingEntry_t* e = &entries[(oldest + i) % EVENT_RING_MAX_FRAMES];
+        const char* data = (const char*)ring + e->offset;
+        int headLen = snprintf(head, sizeof(head),
+                               "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n",
+                               (unsigned)e->jpegLen);
+        struct iovec iov[4] = {
+            { head, (size_t)headLen },
+            { (void*)data, e->metaLen },
+            { (void*)(data + e->metaLen), e->jpegLen },
+            { (void*)PART_TRAILER, sizeof(PART_TRAILER) - 1 },
+        };
+        ok = streamSendAllv(fd, iov, 4);
+    }
+    if (ok) ok = streamSendAll(fd, "--frame--\r\n", 11);
+    streamSocketRelease(fd);
+    clipDone(ok);
+    vTaskDelete(NULL);
+}
+
+// Freezes first if the backend did not, then hands the socket to a clip
+// task so the server task is free again at once
+static esp_err_t handleClip(httpd_req_t* req) {
+    if (!ring) return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "ring disabled");
+    int fd = httpd_req_to_sockfd(req);
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    bool busy = sending;
+    if (!busy) {
+        frozen = true;
+        frozenMs = millis();
+        sending = true;
+    }
+    xSemaphoreGive(ringMutex);
+    if (busy || !streamSocketHold(fd)) {
+        if (!busy) clipDone(false);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "clip download in progress");
+        return ESP_OK;
+    }
+
+    bool started = streamSendAll(fd, CLIP_HEAD, sizeof(CLIP_HEAD) - 1)
+                && xTaskCreate(clipTask, "clip", EVENT_RING_TASK_STACK, (void*)(intptr_t)fd,
+                               EVENT_RING_CLIP_PRIORITY, NULL) == pdPASS;
+    if (!started) {
+        streamSocketRelease(fd);        // Closes the session
+        clipDone(false);
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+bool eventRingStart(uint32_t kb) {
+    if (kb == 0) return false;
+    ringSize = kb * 1024;
+    ring = (uint8_t*)heap_caps_malloc(ringSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ring) {
+        ringSize = 0;
+        return false;
+    }
+    ringMutex = xSemaphoreCreateMutex();
+    if (xTaskCreate(recorderTask, "ring", EVENT_RING_TASK_STACK, NULL,
+                    EVENT_RING_TASK_PRIORITY, NULL) != pdPASS) {
+        heap_caps_free(ring);
+        ring = NULL;
+        ringSize = 0;
+        return false;
+    }
+    return true;
+}
+
+void eventRingRegister(httpd_handle_t server) {
+    httpd_uri_t freezeUri = { "/clip/freeze", HTTP_POST, handleFreeze, NULL };
+    httpd_uri_t releaseUri = { "/clip/release", HTTP_POST, handleRelease, NULL };
+    httpd_uri_t clipUri = { "/clip", HTTP_GET, handleClip, NULL };
+    httpd_register_uri_handler(server, &freezeUri);
+    httpd_register_uri_handler(server, &releaseUri);
+    httpd_register_uri_handler(server, &clipUri);
+}
+
+EventRingStats_t eventRingStats() {
+    EventRingStats_t s = { ring != NULL, false, 0, 0, 0, ringSize };
+    if (!ring) return s;
+    xSemaphoreTake(ringMutex, portMAX_DELAY);
+    s.frozen = frozen;
+    s.frames = count;
+    s.bytes = usedBytes;
+    if (count > 1) {
+        const RingEntry_t* first = &entries[oldest];
+        const RingEntry_t* last = &entries[(oldest + count - 1) % EVENT_RING_MAX_FRAMES];
+        s.spanMs = (uint32_t)((last->tsUs - first->tsUs) / 1000);
+    }
+    xSemaphoreGive(ringMutex);
+    return s;
+}
@@ -0,0 +1,52 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Pre-event Ring
+ * The last few seconds of JPEG frames, kept in PSRAM so a detection can
+ * be reviewed from before it happened.
+ *
+ * A recorder task takes frames from the frame hub (up to
+ * EVENT_RING_FPS) and copies them into one byte ring bounded by size,
+ * evicting the oldest whole frames. The byte bound, not a frame count,
+ * keeps memory fixed whatever the frame size and quality. Recording keeps
+ * the capture task running even with no viewers.
+ *
+ * The backend freezes the ring when it sees a hazard (POST /clip/freeze),
+ * then downloads it (GET /clip) as multipart parts with the same X-*
+ * headers as /stream. Recording pauses while frozen; live streaming is
+ * unaffected. Like a stream client, the download gets a task of its own
+ * at EVENT_RING_CLIP_PRIORITY: capture and the stream senders always
+ * preempt it, and the server task stays free for /stats, /config and new
+ * /stream connects while the ring goes out. One download at a time; a
+ * second GET /clip gets 503. A freeze not followed by a download is
+ * released after EVENT_RING_FREEZE_MAX_MS.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <esp_http_server.h>
+
+#define EVENT_RING_KB_DEFAULT       1024    // PSRAM for the ring; ~10 s of VGA at 10 fps
+#define EVENT_RING_MAX_FRAMES       256     // Index entries
+#define EVENT_RING_FPS              10
+#define EVENT_RING_TASK_STACK       3072
+#define EVENT_RING_TASK_PRIORITY    3       // Below the stream senders
+#define EVENT_RING_CLIP_PRIORITY    2       // Clip task, below the recorder
+#define EVENT_RING_FREEZE_MAX_MS    60000
+
+typedef struct {
+    bool enabled;
+    bool frozen;
+    uint16_t frames;
+    uint32_t bytes;
+    uint32_t spanMs;            // Oldest to newest frame
+    uint32_t capacityBytes;
+} EventRingStats_t;
+
+// Allocates the ring in PSRAM and starts recording; false if the
+// allocation failed (recording stays off)
+bool eventRingStart(uint32_t kb);
+
+// Adds POST /clip/freeze, POST /clip/release and GET /clip
+void eventRingRegister(httpd_handle_t server);
+
+EventRingStats_t eventRingStats();
@@ -0,0 +1,50 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Frame Analysis
+ */
+
+#include "frame_analysis.h"
+
+#include <string.h>
+#include "esp_jpg_decode.h"
+
+typedef struct {
+    const camera_fb_t* fb;
+    uint8_t scale;              // Sensor pixels per decoded pixel
+} DecodeCtx_t;
+
+static size_t readJpeg(void* arg, size_t index, uint8_t* buf, size_t len) {
+    const camera_fb_t* fb = ((DecodeCtx_t*)arg)->fb;
+    if (index >= fb->len) return 0;
+    if (index + len > fb->len) len = fb->len - index;
+    if (buf) memcpy(buf, fb->buf + index, len);
+    return len;
+}
+
+// Start (x = y = 0, no data) carries the output size; end carries nothing.
+// The decoder ignores a false return, so an oversize motion grid is
+// handled by the gate itself and the hazard filter still gets every tile.
+static bool writeTile(void* arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t* data) {
+    DecodeCtx_t* ctx = (DecodeCtx_t*)arg;
+    if (!data) {
+        if (x == 0 && y == 0) motionGateBegin(w, h, ctx->scale);
+        return true;
+    }
+    hazardFilterTile(w, h, data);
+    motionGateTile(x, y, w, h, data);
+    return true;
+}
+
+FrameAnalysis_t frameAnalyze(const camera_fb_t* fb, uint32_t nowMs) {
+    jpg_scale_t scale = hazardFilterScale(fb->width);
+    DecodeCtx_t ctx = { fb, (uint8_t)(1 << scale) };
+
+    hazardFilterBegin();
+    motionGateBegin(0, 0, ctx.scale);           // Nothing scored if no start arrives
+    bool decoded = fb->format == PIXFORMAT_JPEG
+                && esp_jpg_decode(fb->len, scale, readJpeg, writeTile, &ctx) == ESP_OK;
+
+    FrameAnalysis_t result;
+    result.motion = motionGateFinish(decoded, nowMs);
+    result.hazard = hazardFilterFinish(decoded);
+    return result;
+}
@@ -0,0 +1,24 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Frame Analysis
+ * One reduced-scale JPEG decode per captured frame feeding both on-camera
+ * analyzers, so the capture task pays for a single decode before publish.
+ *
+ * The scale is the hazard pre-filter's (output near QQVGA width); each
+ * decoded tile goes to the hazard filter, which sums every pixel, and to
+ * the motion gate, which averages it down to its 8x8-sensor-pixel cells.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_camera.h"
+#include "hazard_filter.h"
+#include "motion_gate.h"
+
+typedef struct {
+    MotionResult_t motion;
+    HazardResult_t hazard;
+} FrameAnalysis_t;
+
+// Capture task only (the analyzers keep per-scene state)
+FrameAnalysis_t frameAnalyze(const camera_fb_t* fb, uint32_t nowMs);
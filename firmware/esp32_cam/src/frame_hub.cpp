@@ -0,0 +1,258 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Frame Hub
+ */
+
+#include "frame_hub.h"
+
+#include <esp_timer.h>
+#include "frame_analysis.h"
+#include "model_mode.h"
+#include "rate_control.h"
+
+// One slot per driver buffer; a slot is free when refs == 0
+static Frame_t slots[FRAME_HUB_FB_MAX];
+static uint8_t fbCount = FRAME_HUB_FB_COUNT;
+static Frame_t* latest = NULL;
+static uint32_t nextSeq = 1;
+static TaskHandle_t subscribers[FRAME_HUB_MAX_SUBSCRIBERS];
+static TaskHandle_t captureTaskHandle = NULL;
+static FrameHubStats_t stats;
+static uint32_t windowStartMs = 0, windowFrames = 0;
+static portMUX_TYPE hubLock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t subscriberCount() {
+    uint8_t n = 0;
+    for (int i = 0; i < FRAME_HUB_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i]) n++;
+    }
+    return n;
+}
+
+// ============================================================================
+// CAPTURE TASK
+// ============================================================================
+static void captureTask(void* parameter) {
+    while (true) {
+        portENTER_CRITICAL(&hubLock);
+        uint8_t listeners = subscriberCount();
+        portEXIT_CRITICAL(&hubLock);
+        if (listeners == 0) {
+            // Idle until frameHubSubscribe() wakes us
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        // Quality / frame size changes take effect between frames
+        rateControlTick(millis());
+        uint8_t quality = rateControlState().quality;
+
+        // Every buffer held: the driver has none to fill and the grab would
+        // block. Let the hub's latest go; anyone who has not taken it yet
+        // gets the frame about to be captured instead.
+        Frame_t* dropLatest = NULL;
+        portENTER_CRITICAL(&hubLock);
+        uint8_t held = 0;
+        for (int i = 0; i < fbCount; i++) {
+            if (slots[i].refs > 0) held++;
+        }
+        if (held == fbCount && latest) {
+            dropLatest = latest;
+            latest = NULL;
+            stats.latestDrops++;
+        }
+        portEXIT_CRITICAL(&hubLock);
+        if (dropLatest) frameHubRelease(dropLatest);
+
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            portENTER_CRITICAL(&hubLock);
+            stats.driverMisses++;
+            portEXIT_CRITICAL(&hubLock);
+            delay(10);
+            continue;
+        }
+
+        // The driver reports its init frame size; a raw model window has its own
+        const ModelGeometry_t& model = modelGeometry();
+        if (model.active) {
+            fb->width = model.width;
+            fb->height = model.height;
+        }
+
+        // Scored once here, one decode for both; each consumer decides
+        // what to do with it
+        int64_t t0 = esp_timer_get_time();
+        FrameAnalysis_t analysis = frameAnalyze(fb, millis());
+        int64_t t1 = esp_timer_get_time();
+        uint32_t analysisUs = (uint32_t)(t1 - t0);
+
+        // Every driver buffer maps to at most one live slot, so a free one
+        // always exists while the driver handed us a buffer
+        Frame_t* previous = NULL;
+        TaskHandle_t wake[FRAME_HUB_MAX_SUBSCRIBERS];
+        portENTER_CRITICAL(&hubLock);
+        Frame_t* slot = NULL;
+        for (int i = 0; i < fbCount && !slot; i++) {
+            if (slots[i].refs == 0) slot = &slots[i];
+        }
+        if (slot) {
+            slot->fb = fb;
+            slot->seq = nextSeq++;
+            if (nextSeq == 0) nextSeq = 1;
+            slot->quality = quality;
+            slot->motion = analysis.motion.score;
+            slot->active = analysis.motion.active;
+            slot->fire = analysis.hazard.fire;
+            slot->smoke = analysis.hazard.smoke;
+            slot->analysisUs = analysisUs;
+            slot->publishedUs = t1;
+            slot->taken = false;
+            slot->refs = 1;             // The hub's own reference
+            previous = latest;
+            latest = slot;
+            if (previous && !previous->taken) stats.superseded++;
+            stats.captured++;
+            windowFrames++;
+        }
+        memcpy(wake, subscribers, sizeof(wake));
+        stats.analysisUs += ((int32_t)analysisUs - (int32_t)stats.analysisUs) / 8;
+        if (analysisUs > stats.maxUs) stats.maxUs = analysisUs;
+        uint32_t now = millis();
+        if (now - windowStartMs >= 1000) {
+            stats.fps = windowFrames * 1000.0f / (now - windowStartMs);
+            windowStartMs = now;
+            windowFrames = 0;
+        }
+        portEXIT_CRITICAL(&hubLock);
+
+        if (!slot) {
+            esp_camera_fb_return(fb);
+            continue;
+        }
+        if (previous) frameHubRelease(previous);
+        for (int i = 0; i < FRAME_HUB_MAX_SUBSCRIBERS; i++) {
+            if (wake[i]) xTaskNotifyGive(wake[i]);
+        }
+    }
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+bool frameHubStart(uint8_t count) {
+    fbCount = (count < FRAME_HUB_FB_MAX) ? count : FRAME_HUB_FB_MAX;
+    return xTaskCreate(captureTask, "capture", FRAME_HUB_TASK_STACK, NULL,
+                       FRAME_HUB_TASK_PRIORITY, &captureTaskHandle) == pdPASS;
+}
+
+FrameHubStats_t frameHubStats() {
+    portENTER_CRITICAL(&hubLock);
+    FrameHubStats_t copy = stats;
+    portEXIT_CRITICAL(&hubLock);
+    return copy;
+}
+
+uint8_t frameHazard(const Frame_t* frame) {
+    return (frame->fire > frame->smoke) ? frame->fire : frame->smoke;
+}
+
+int frameFormatHeaders(const Frame_t* frame, uint32_t prevSendMs, uint32_t gated,
+                       char* buf, size_t len) {
+    const camera_fb_t* fb = frame->fb;
+    int64_t nowUs = esp_timer_get_time();
+    int n = snprintf(buf, len,
+                     "X-Seq: %u\r\nX-Gated: %u\r\nX-Timestamp: %ld.%06ld\r\n"
+                     "X-Framesize: %ux%u\r\nX-Quality: %u\r\nX-Motion: %u\r\n"
+                     "X-Fire: %u\r\nX-Smoke: %u\r\n"
+                     "X-Age-Ms: %u\r\nX-Queue-Ms: %u\r\nX-Analysis-Us: %u\r\nX-Send-Ms: %u\r\n",
+                     frame->seq, gated, (long)fb->timestamp.tv_sec, (long)fb->timestamp.tv_usec,
+                     (unsigned)fb->width, (unsigned)fb->height,
+                     frame->quality, frame->motion, frame->fire, frame->smoke,
+                     frameAgeMs(frame), (unsigned)((nowUs - frame->publishedUs) / 1000),
+                     frame->analysisUs, prevSendMs);
+
+    // Settings last applied to the sensor (the driver does not read back
+    // the live auto exposure / gain values)
+    sensor_t* s = esp_camera_sensor_get();
+    if (s && n > 0 && (size_t)n < len) {
+        const camera_status_t& st = s->status;
+        n += snprintf(buf + n, len - n,
+                      "X-Sensor: aec=%u,aec_value=%u,ae_level=%d,agc=%u,agc_gain=%u,"
+                      "awb=%u,wb_mode=%u,brightness=%d,contrast=%d,saturation=%d\r\n",
+                      st.aec, st.aec_value, st.ae_level, st.agc, st.agc_gain,
+                      st.awb, st.wb_mode, st.brightness, st.contrast, st.saturation);
+    }
+    const ModelGeometry_t& model = modelGeometry();
+    if (model.active && (size_t)n < len) {
+        n += snprintf(buf + n, len - n,
+                      "X-Model-Size: %u\r\nX-Model-Pad: %u,%u\r\nX-Model-Src: %u,%u,%u,%u\r\n",
+                      model.size, model.padX, model.padY,
+                      model.srcX, model.srcY, model.srcW, model.srcH);
+    }
+    return (n < (int)len) ? n : (int)len - 1;
+}
+
+uint32_t frameAgeMs(const Frame_t* frame) {
+    int64_t capturedUs = (int64_t)frame->fb->timestamp.tv_sec * 1000000 + frame->fb->timestamp.tv_usec;
+    int64_t age = esp_timer_get_time() - capturedUs;
+    return (age > 0) ? (uint32_t)(age / 1000) : 0;
+}
+
+bool frameHubSubscribe(TaskHandle_t task) {
+    bool added = false;
+    portENTER_CRITICAL(&hubLock);
+    for (int i = 0; i < FRAME_HUB_MAX_SUBSCRIBERS && !added; i++) {
+        if (!subscribers[i]) {
+            subscribers[i] = task;
+            added = true;
+        }
+    }
+    portEXIT_CRITICAL(&hubLock);
+    if (added && captureTaskHandle) xTaskNotifyGive(captureTaskHandle);
+    return added;
+}
+
+void frameHubUnsubscribe(TaskHandle_t task) {
+    Frame_t* drop = NULL;
+    portENTER_CRITICAL(&hubLock);
+    for (int i = 0; i < FRAME_HUB_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i] == task) subscribers[i] = NULL;
+    }
+    // Nobody left to send it to: give the buffer back to the driver
+    if (subscriberCount() == 0) {
+        drop = latest;
+        latest = NULL;
+    }
+    portEXIT_CRITICAL(&hubLock);
+    if (drop) frameHubRelease(drop);
+}
+
+Frame_t* frameHubAcquire(uint32_t lastSeq, uint32_t waitMs) {
+    uint32_t start = millis();
+    while (true) {
+        Frame_t* frame = NULL;
+        portENTER_CRITICAL(&hubLock);
+        if (latest && latest->seq != lastSeq) {
+            frame = latest;
+            frame->refs++;
+            frame->taken = true;
+        }
+        portEXIT_CRITICAL(&hubLock);
+        if (frame) return frame;
+
+        uint32_t waited = millis() - start;
+        if (waited >= waitMs) return NULL;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs - waited));
+    }
+}
+
+void frameHubRelease(Frame_t* frame) {
+    camera_fb_t* done = NULL;
+    portENTER_CRITICAL(&hubLock);
+    if (--frame->refs == 0) {
+        done = frame->fb;
+        frame->fb = NULL;
+    }
+    portEXIT_CRITICAL(&hubLock);
+    if (done) esp_camera_fb_return(done);
+}
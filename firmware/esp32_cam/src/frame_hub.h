@@ -0,0 +1,89 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Frame Hub
+ * One capture task grabs each frame once and publishes it to every
+ * subscriber as a reference-counted handle to the driver's own buffer.
+ *
+ * The hub holds one reference to the latest frame and each sender one
+ * per frame it is transmitting; the buffer goes back to the driver
+ * (esp_camera_fb_return) when the last reference is dropped. Viewers
+ * therefore cost network bandwidth only: no extra captures, no copies.
+ * A slow client keeps at most one older buffer. FRAME_HUB_FB_COUNT lets
+ * every /stream client and the push client hold a different one and
+ * still leaves the driver a buffer to fill; with the event ring enabled
+ * its recorder gets one more (FRAME_HUB_FB_MAX). Should all of them be
+ * held anyway, the hub gives up its own reference to the latest frame
+ * before the next grab rather than stall capture for everyone.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "esp_camera.h"
+#include "stream_server.h"
+
+#define FRAME_HUB_FB_COUNT          (STREAM_MAX_CLIENTS + 2)   // Driver buffers: one per sender + push + one filling
+#define FRAME_HUB_FB_MAX            (FRAME_HUB_FB_COUNT + 1)   // Plus the event ring recorder
+#define FRAME_HUB_MAX_SUBSCRIBERS   6
+#define FRAME_HUB_TASK_STACK        4096
+#define FRAME_HUB_TASK_PRIORITY     6       // Above the senders: capture never waits on the network
+
+typedef struct {
+    camera_fb_t* fb;
+    uint32_t seq;               // Capture sequence number, never 0
+    uint8_t quality;            // jpeg_quality in effect when captured
+    uint8_t motion;             // Scene change score, % of blocks (motion_gate.h)
+    bool active;                // Motion gate open
+    uint8_t fire;               // Pre-filter likelihoods, 0-100 (hazard_filter.h)
+    uint8_t smoke;
+    uint32_t analysisUs;        // Decode + motion + hazard analysis of this frame
+    int64_t publishedUs;        // Handed to subscribers (esp_timer clock)
+    bool taken;                 // Acquired by at least one consumer
+    uint16_t refs;              // Guarded by the hub lock
+} Frame_t;
+
+// Capture counters, plus the per-frame cost of the on-camera analysis
+// smoothed over ~8 frames so it can be checked against the capture
+// interval (1000 / target fps)
+typedef struct {
+    uint32_t captured;
+    float fps;                  // Captured over the last second
+    uint32_t driverMisses;      // esp_camera_fb_get() returned nothing
+    uint32_t superseded;        // Replaced by a newer frame before anyone took it
+    uint32_t latestDrops;       // Latest released early: every buffer was held
+    uint32_t analysisUs;        // One decode feeding motion + hazard (frame_analysis.h)
+    uint32_t maxUs;             // Worst frame since boot
+} FrameHubStats_t;
+
+// fbCount: the driver's buffer count (camera_config_t::fb_count), at
+// most FRAME_HUB_FB_MAX
+bool frameHubStart(uint8_t fbCount);
+FrameHubStats_t frameHubStats();
+
+// Higher of a frame's fire and smoke likelihoods
+uint8_t frameHazard(const Frame_t* frame);
+
+// The frame's metadata as "X-Name: value\r\n" lines, shared by every
+// transport: sequence number and capture timestamp, geometry, encoder and
+// sensor settings, analysis scores, model window, and the timing
+// breakdown up to now (capture age, time since publish, analysis cost,
+// and prevSendMs, the transport's send time for its previous frame).
+// gated is how many frames the motion gate withheld since the previous
+// one sent, so a receiver can tell those X-Seq gaps from real drops.
+// Call right before sending. Returns the length written.
+#define FRAME_HEADERS_MAX       448
+int frameFormatHeaders(const Frame_t* frame, uint32_t prevSendMs, uint32_t gated,
+                       char* buf, size_t len);
+
+// Capture-to-now age of a frame (driver timestamp, esp_timer clock)
+uint32_t frameAgeMs(const Frame_t* frame);
+
+// Sender tasks register to be woken for each new frame. Capture runs only
+// while someone is subscribed.
+bool frameHubSubscribe(TaskHandle_t task);
+void frameHubUnsubscribe(TaskHandle_t task);
+
+// Newest frame if its seq differs from lastSeq, waiting up to waitMs for
+// one. The caller owns a reference and must frameHubRelease() it.
+Frame_t* frameHubAcquire(uint32_t lastSeq, uint32_t waitMs);
+void frameHubRelease(Frame_t* frame);
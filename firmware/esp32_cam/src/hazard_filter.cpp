@@ -0,0 +1,97 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Hazard Pre-filter
+ */
+
+#include "hazard_filter.h"
+
+#include <math.h>
+#include <string.h>
+
+// Previous frame means for the fire rules; mid-grey until the first frame
+static uint8_t meanY = 128, meanCb = 128, meanCr = 128;
+static float baselineStd = 0;   // 0 until the first clear frame
+
+// Sums of the current pass
+typedef struct {
+    uint32_t pixels;
+    uint32_t firePixels;
+    uint32_t sumY, sumCb, sumCr, sumSat;
+    uint64_t sumY2;
+} HazardCtx_t;
+
+static HazardCtx_t ctx;
+
+jpg_scale_t hazardFilterScale(uint16_t width) {
+    if (width >= HAZARD_TARGET_W * 8) return JPG_SCALE_8X;
+    if (width >= HAZARD_TARGET_W * 4) return JPG_SCALE_4X;
+    if (width >= HAZARD_TARGET_W * 2) return JPG_SCALE_2X;
+    return JPG_SCALE_NONE;
+}
+
+void hazardFilterBegin() {
+    memset(&ctx, 0, sizeof(ctx));
+}
+
+// Tiles arrive as R, G, B; nothing is stored, only the frame sums
+void hazardFilterTile(uint16_t w, uint16_t h, const uint8_t* rgb) {
+    uint32_t count = (uint32_t)w * h;
+    for (uint32_t i = 0; i < count; i++, rgb += 3) {
+        int r = rgb[0], g = rgb[1], b = rgb[2];
+        int yy = (77 * r + 150 * g + 29 * b) >> 8;
+        int cb = 128 + ((-43 * r - 85 * g + 128 * b) >> 8);
+        int cr = 128 + ((128 * r - 107 * g - 21 * b) >> 8);
+
+        ctx.sumY += yy;
+        ctx.sumY2 += yy * yy;
+        ctx.sumCb += cb;
+        ctx.sumCr += cr;
+        ctx.sumSat += abs(cb - 128) + abs(cr - 128);
+        if (yy > cb && cr > cb && cr - cb >= HAZARD_FIRE_CRCB_MIN
+            && yy > meanY && cb < meanCb && cr > meanCr) {
+            ctx.firePixels++;
+        }
+    }
+    ctx.pixels += count;
+}
+
+HazardResult_t hazardFilterFinish(bool decoded) {
+    HazardResult_t result = { 0, 0 };
+    if (!decoded || ctx.pixels == 0) return result;
+
+    uint32_t n = ctx.pixels;
+    meanY = ctx.sumY / n;
+    meanCb = ctx.sumCb / n;
+    meanCr = ctx.sumCr / n;
+
+    uint32_t firePermille = ctx.firePixels * 1000 / n;
+    result.fire = (firePermille >= HAZARD_FIRE_PERMILLE_FULL)
+        ? 100 : (uint8_t)(firePermille * 100 / HAZARD_FIRE_PERMILLE_FULL);
+
+    float mean = (float)ctx.sumY / n;
+    float var = (float)ctx.sumY2 / n - mean * mean;
+    float std = (var > 0) ? sqrtf(var) : 0;
+    uint32_t sat = ctx.sumSat / n;
+
+    if (baselineStd <= 0) {
+        baselineStd = std;
+        return result;
+    }
+
+    if (baselineStd > 1 && std < baselineStd && meanY >= HAZARD_SMOKE_Y_MIN
+        && sat <= HAZARD_SMOKE_SAT_MAX) {
+        float drop = (baselineStd - std) * 100 / baselineStd;
+        if (drop >= HAZARD_SMOKE_DROP_FULL) {
+            result.smoke = 100;
+        } else if (drop > HAZARD_SMOKE_DROP_MIN) {
+            result.smoke = (uint8_t)((drop - HAZARD_SMOKE_DROP_MIN) * 100
+                                     / (HAZARD_SMOKE_DROP_FULL - HAZARD_SMOKE_DROP_MIN));
+        }
+    }
+
+    // Learn the scene's normal contrast only from frames that look clear,
+    // so a slowly filling room does not become the new normal
+    if (result.smoke == 0) {
+        baselineStd += (std - baselineStd) / (1 << HAZARD_BASELINE_SHIFT);
+    }
+    return result;
+}
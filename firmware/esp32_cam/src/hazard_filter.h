@@ -0,0 +1,52 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Hazard Pre-filter
+ * Colour heuristics for fire and smoke, run on every captured frame so
+ * the backend can put likely hazard frames ahead of the rest instead of
+ * finding out one network hop and one YOLO pass later. It is a
+ * prioritisation hint, not a detector: false positives only cost an
+ * early inference.
+ *
+ * Pixels come from the shared reduced-scale decode (frame_analysis.h),
+ * whose scale hazardFilterScale() picks to land near QQVGA width (1/4 of
+ * VGA, 1/2 of QVGA, 1/8 from 1280 px up), and every pixel is converted to
+ * YCbCr (BT.601, integer):
+ *  - fire:  Y > Cb, Cr > Cb, Cr - Cb >= HAZARD_FIRE_CRCB_MIN and Y, Cr
+ *           above / Cb below the frame means (Celik & Demirel rules;
+ *           means come from the previous frame so one pass suffices)
+ *  - smoke: haze flattens contrast and washes out colour, so the score
+ *           is the drop of the luma standard deviation below a slow
+ *           baseline, counted only while the frame is bright enough and
+ *           nearly grey
+ * Both are reported as 0-100 likelihoods; HAZARD_LIKELY marks a frame
+ * worth fast-pathing.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_camera.h"
+#include "esp_jpg_decode.h"
+
+#define HAZARD_TARGET_W             160     // QQVGA: decode scale is picked to land near this
+#define HAZARD_FIRE_CRCB_MIN        40      // Celik tau
+#define HAZARD_FIRE_PERMILLE_FULL   20      // Fire pixels (per mille) scored as likelihood 100
+#define HAZARD_SMOKE_SAT_MAX        24      // Mean |Cb-128| + |Cr-128| of a hazy frame
+#define HAZARD_SMOKE_Y_MIN          70      // Darkness also kills contrast; ignore it
+#define HAZARD_SMOKE_DROP_MIN       20      // % contrast loss where the smoke score starts
+#define HAZARD_SMOKE_DROP_FULL      60      // ... and where it reaches 100
+#define HAZARD_BASELINE_SHIFT       11      // Contrast baseline: 1/2048 per clear frame, minutes at 10 fps
+#define HAZARD_LIKELY               50      // Likelihood that tags a frame for the fast path
+
+typedef struct {
+    uint8_t fire;               // 0-100
+    uint8_t smoke;              // 0-100
+} HazardResult_t;
+
+// Decode scale for a frame `width` sensor pixels wide
+jpg_scale_t hazardFilterScale(uint16_t width);
+
+// One decode pass (frame_analysis.cpp, capture task): begin(), every
+// decoded RGB888 tile, then finish(). Undecodable frames score 0.
+void hazardFilterBegin();
+void hazardFilterTile(uint16_t w, uint16_t h, const uint8_t* rgb);
+HazardResult_t hazardFilterFinish(bool decoded);
@@ -1,9 +1,16 @@
 #include <Arduino.h>
 #include "esp_camera.h"
 #include <WiFi.h>
-#include <WebServer.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
+#include "cpu_load.h"
+#include "event_ring.h"
+#include "frame_hub.h"
+#include "model_mode.h"
+#include "motion_gate.h"
+#include "push_client.h"
+#include "rate_control.h"
+#include "stream_server.h"
 
 // ============================================================================
 // AI-THINKER ESP32-CAM PIN DEFINITIONS
@@ -26,19 +33,30 @@
 #define PCLK_GPIO_NUM     22
 #define LED_FLASH_PIN      4
 
+#define JPEG_QUALITY_START  12
+
 // ============================================================================
 // GLOBAL STATE
 // ============================================================================
-WebServer server(81);
+httpd_handle_t server = NULL;
 Preferences preferences;
 bool isAPMode = false;
 String ssid = "";
 String password = "";
 String server_ip = "";
+uint16_t pushPort = PUSH_PORT_DEFAULT;
+uint32_t ringKb = EVENT_RING_KB_DEFAULT;
+RateConfig_t rateConfig = RATE_CONFIG_DEFAULT;
+ModelConfig_t modelConfig = MODEL_CONFIG_DEFAULT;
 
 // ============================================================================
 // CAMERA INITIALIZATION
 // ============================================================================
+// The event ring's recorder holds a frame like any sender
+uint8_t frameBufferCount() {
+    return (ringKb != 0) ? FRAME_HUB_FB_MAX : FRAME_HUB_FB_COUNT;
+}
+
 bool initCamera() {
     camera_config_t config;
     config.ledc_channel = LEDC_CHANNEL_0;
@@ -61,63 +79,144 @@ bool initCamera() {
     config.pin_reset = RESET_GPIO_NUM;
     config.xclk_freq_hz = 20000000;
     config.pixel_format = PIXFORMAT_JPEG;
-    config.frame_size = FRAMESIZE_VGA;
-    config.jpeg_quality = 12;
-    config.fb_count = 2;
+    // Buffers are sized for the largest frame the rate control may select,
+    // or for the model window, which then stays fixed
+    bool model = modelConfigValid(modelConfig);
+    config.frame_size = model ? modelDriverFrameSize(modelConfig) : rateConfig.sizeMax;
+    config.jpeg_quality = constrain(JPEG_QUALITY_START, rateConfig.qualityBest, rateConfig.qualityWorst);
+    // One buffer per frame the hub can have outstanding (frame_hub.h)
+    config.fb_count = frameBufferCount();
+    config.fb_location = CAMERA_FB_IN_PSRAM;
     // I set the grab mode to 'LATEST' to discard old frames if the network is slow, minimizing latency.
     config.grab_mode = CAMERA_GRAB_LATEST;
 
     esp_err_t err = esp_camera_init(&config);
-    return (err == ESP_OK);
+    if (err != ESP_OK) return false;
+
+    if (model) {
+        if (modelModeBegin(modelConfig)) {
+            const ModelGeometry_t& g = modelGeometry();
+            Serial.printf("Model mode: %ux%u for %u input\n", g.width, g.height, g.size);
+        } else {
+            Serial.println("Model mode unsupported by sensor, streaming normally");
+        }
+        // Quality only: a frame size step would reset the window
+        rateConfig.sizeMin = rateConfig.sizeMax = config.frame_size;
+    }
+    rateControlBegin(rateConfig, config.jpeg_quality, config.frame_size);
+    return true;
 }
 
 // ============================================================================
-// MJPEG HANDLER
+// RATE CONTROL CONFIGURATION
 // ============================================================================
-void handleStream() {
-    WiFiClient client = server.client();
-    String response = "HTTP/1.1 200 OK\r\n";
-    response += "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n\r\n";
-    server.sendContent(response);
-
-    while (client.connected()) {
-        camera_fb_t *fb = esp_camera_fb_get();
-        if (!fb) continue;
-
-        String header = "--frame\r\n";
-        header += "Content-Type: image/jpeg\r\n";
-        header += "Content-Length: " + String(fb->len) + "\r\n\r\n";
-        server.sendContent(header);
-        client.write(fb->buf, fb->len);
-        server.sendContent("\r\n");
-
-        esp_camera_fb_return(fb);
-        delay(1);
+void loadRateConfig() {
+    RateConfig_t d = RATE_CONFIG_DEFAULT;
+    preferences.begin("nexora", true);
+    rateConfig.targetFps = preferences.getUChar("rc_fps", d.targetFps);
+    rateConfig.targetLatencyMs = preferences.getUShort("rc_lat", d.targetLatencyMs);
+    rateConfig.qualityBest = preferences.getUChar("rc_qbest", d.qualityBest);
+    rateConfig.qualityWorst = preferences.getUChar("rc_qworst", d.qualityWorst);
+    rateConfig.sizeMin = (framesize_t)preferences.getUChar("rc_fsmin", d.sizeMin);
+    rateConfig.sizeMax = (framesize_t)preferences.getUChar("rc_fsmax", d.sizeMax);
+    preferences.end();
+
+    // A bad stored set falls back to the defaults rather than bricking capture;
+    // so does a largest size the motion gate cannot decode
+    if (rateConfig.qualityBest > rateConfig.qualityWorst || rateConfig.qualityWorst > 63
+        || rateConfig.sizeMin > rateConfig.sizeMax || rateConfig.sizeMax > FRAMESIZE_UXGA
+        || !motionGateFits(resolution[rateConfig.sizeMax].width, resolution[rateConfig.sizeMax].height)
+        || rateConfig.targetFps == 0) {
+        rateConfig = d;
     }
 }
 
+// Optional "rate":{"fps":..,"latency_ms":..,"quality_best":..,"quality_worst":..,
+// "framesize_min":..,"framesize_max":..} in the /config body (framesize_t values)
+void saveRateConfig(JsonObjectConst rate) {
+    if (rate.isNull()) return;
+    preferences.begin("nexora", false);
+    if (rate.containsKey("fps")) preferences.putUChar("rc_fps", rate["fps"]);
+    if (rate.containsKey("latency_ms")) preferences.putUShort("rc_lat", rate["latency_ms"]);
+    if (rate.containsKey("quality_best")) preferences.putUChar("rc_qbest", rate["quality_best"]);
+    if (rate.containsKey("quality_worst")) preferences.putUChar("rc_qworst", rate["quality_worst"]);
+    if (rate.containsKey("framesize_min")) preferences.putUChar("rc_fsmin", rate["framesize_min"]);
+    if (rate.containsKey("framesize_max")) preferences.putUChar("rc_fsmax", rate["framesize_max"]);
+    preferences.end();
+}
+
+// ============================================================================
+// MODEL MODE CONFIGURATION
+// ============================================================================
+void loadModelConfig() {
+    preferences.begin("nexora", true);
+    modelConfig.size = preferences.getUShort("mm_size", 0);
+    modelConfig.fit = (ModelFit_t)preferences.getUChar("mm_fit", MODEL_FIT_CROP);
+    preferences.end();
+}
+
+// Optional "model":{"size":640,"fit":"crop"|"pad"} in the /config body;
+// size 0 turns the mode off
+void saveModelConfig(JsonObjectConst model) {
+    if (model.isNull()) return;
+    preferences.begin("nexora", false);
+    if (model.containsKey("size")) preferences.putUShort("mm_size", model["size"]);
+    if (model.containsKey("fit")) {
+        preferences.putUChar("mm_fit", strcmp(model["fit"] | "crop", "pad") == 0 ? MODEL_FIT_PAD : MODEL_FIT_CROP);
+    }
+    preferences.end();
+}
+
 // ============================================================================
 // PROVISIONING HANDLER
 // ============================================================================
-void handleConfig() {
-    if (server.hasArg("plain")) {
-        StaticJsonDocument<256> doc;
-        deserializeJson(doc, server.arg("plain"));
-        
-        ssid = doc["ssid"].as<String>();
-        password = doc["password"].as<String>();
-        server_ip = doc["server_ip"].as<String>();
-
-        preferences.begin("nexora", false);
-        preferences.putString("ssid", ssid);
-        preferences.putString("password", password);
-        preferences.putString("server_ip", server_ip);
-        preferences.end();
-
-        server.send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Rebooting...\"}");
-        delay(1000);
-        ESP.restart();
+// httpd_req_recv may return part of the body; a short read must not end
+// up as "null" credentials in Preferences
+bool recvBody(httpd_req_t *req, char *buf, size_t cap, size_t *outLen) {
+    size_t total = req->content_len;
+    if (total == 0 || total >= cap) return false;
+    size_t got = 0;
+    int timeouts = 0;
+    while (got < total) {
+        int n = httpd_req_recv(req, buf + got, total - got);
+        if (n == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts < 3) continue;
+        if (n <= 0) return false;
+        got += n;
+    }
+    *outLen = got;
+    return true;
+}
+
+esp_err_t handleConfig(httpd_req_t *req) {
+    char body[448];
+    size_t len = 0;
+    StaticJsonDocument<640> doc;
+    if (!recvBody(req, body, sizeof(body), &len) || deserializeJson(doc, body, len)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "expected JSON body");
+        return ESP_FAIL;
     }
+
+    ssid = doc["ssid"].as<String>();
+    password = doc["password"].as<String>();
+    server_ip = doc["server_ip"].as<String>();
+
+    preferences.begin("nexora", false);
+    preferences.putString("ssid", ssid);
+    preferences.putString("password", password);
+    preferences.putString("server_ip", server_ip);
+    // "push_port": 0 turns push delivery off
+    if (doc.containsKey("push_port")) preferences.putUShort("push_port", doc["push_port"]);
+    // "ring_kb": PSRAM for the pre-event clip ring, 0 turns it off
+    if (doc.containsKey("ring_kb")) preferences.putUInt("ring_kb", doc["ring_kb"]);
+    preferences.end();
+    saveRateConfig(doc["rate"].as<JsonObjectConst>());
+    saveModelConfig(doc["model"].as<JsonObjectConst>());
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, "{\"status\":\"ok\",\"message\":\"Rebooting...\"}");
+    delay(1000);
+    ESP.restart();
+    return ESP_OK;
 }
 
 void setup() {
@@ -125,22 +224,28 @@ void setup() {
     pinMode(LED_FLASH_PIN, OUTPUT);
     digitalWrite(LED_FLASH_PIN, LOW);
 
-    if (!initCamera()) {
-        Serial.println("Camera Init Failed");
-        return;
-    }
-
+    cpuLoadBegin();
+    loadRateConfig();
+    loadModelConfig();
+    // ring_kb sizes the driver's buffer pool
     preferences.begin("nexora", true);
     ssid = preferences.getString("ssid", "");
     password = preferences.getString("password", "");
     server_ip = preferences.getString("server_ip", "");
+    pushPort = preferences.getUShort("push_port", PUSH_PORT_DEFAULT);
+    ringKb = preferences.getUInt("ring_kb", EVENT_RING_KB_DEFAULT);
     preferences.end();
 
+    if (!initCamera()) {
+        Serial.println("Camera Init Failed");
+        return;
+    }
+
+    String deviceId = "NEXORA_CAM_" + String((uint32_t)ESP.getEfuseMac(), HEX);
     if (ssid == "") {
         isAPMode = true;
-        String apName = "NEXORA_CAM_" + String((uint32_t)ESP.getEfuseMac(), HEX);
-        WiFi.softAP(apName.c_str());
-        Serial.println("AP Mode: " + apName);
+        WiFi.softAP(deviceId.c_str());
+        Serial.println("AP Mode: " + deviceId);
         Serial.println("IP: " + WiFi.softAPIP().toString());
     } else {
         WiFi.begin(ssid.c_str(), password.c_str());
@@ -159,12 +264,37 @@ void setup() {
         }
     }
 
-    server.on("/stream", HTTP_GET, handleStream);
-    server.on("/config", HTTP_POST, handleConfig);
-    server.begin();
+    // Single capture task feeding every consumer
+    if (!frameHubStart(frameBufferCount())) {
+        Serial.println("Capture Task Start Failed");
+        return;
+    }
+
+    // Last seconds before a detection, frozen and pulled by the backend
+    bool ringOn = ringKb != 0 && eventRingStart(ringKb);
+    if (ringKb != 0 && !ringOn) {
+        Serial.println("Event Ring Start Failed (PSRAM)");
+    }
+
+    // /stream and /stats; every stream client gets its own sender task
+    server = streamServerStart();
+    if (!server) {
+        Serial.println("HTTP Server Start Failed");
+        return;
+    }
+    httpd_uri_t config = { "/config", HTTP_POST, handleConfig, NULL };
+    httpd_register_uri_handler(server, &config);
+    if (ringOn) eventRingRegister(server);
+
+    // Backend ingest without needing a route to the camera
+    if (!isAPMode && server_ip != "" && pushPort != 0) {
+        if (!pushClientStart(server_ip.c_str(), pushPort, deviceId.c_str())) {
+            Serial.println("Push Task Start Failed");
+        }
+    }
 }
 
 void loop() {
-    server.handleClient();
-    delay(1);
+    // HTTP server and stream senders run in their own tasks
+    delay(1000);
 }
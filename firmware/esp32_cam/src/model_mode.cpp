@@ -0,0 +1,96 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Model-Ready Output
+ */
+
+#include "model_mode.h"
+
+#include "motion_gate.h"
+
+// ov2640_sensor_mode_t { UXGA, SVGA, CIF }, passed as set_res_raw's startX
+// on this sensor
+#define OV2640_MODE_UXGA        0       // 1600x1200
+#define OV2640_MODE_SVGA        1       // 800x600 binned window, full frame rate
+
+static ModelGeometry_t geometry;
+
+// Window (mode coordinates) and output for a config; false if the sensor
+// cannot produce it
+static bool plan(const ModelConfig_t& config, int* mode, int* scale, ModelGeometry_t* g) {
+    if (!modelConfigValid(config)) return false;
+    uint16_t size = config.size;
+    bool crop = (config.fit == MODEL_FIT_CROP);
+
+    // Binned SVGA when it still covers the output, UXGA otherwise
+    bool svga = crop ? (size <= 600) : (size <= 800);
+    *mode = svga ? OV2640_MODE_SVGA : OV2640_MODE_UXGA;
+    *scale = svga ? 2 : 1;      // Mode pixels to UXGA pixels
+    uint16_t modeW = 1600 / *scale, modeH = 1200 / *scale;
+
+    g->active = true;
+    g->size = size;
+    if (crop) {
+        g->width = size;
+        g->height = size;
+        g->padX = 0;
+        g->padY = 0;
+        g->srcX = (modeW - modeH) / 2;
+        g->srcY = 0;
+        g->srcW = modeH;
+        g->srcH = modeH;
+    } else {
+        // size is a multiple of 32, so 3/4 of it and the border split evenly
+        g->width = size;
+        g->height = size * 3 / 4;
+        g->padX = 0;
+        g->padY = (size - g->height) / 2;
+        g->srcX = 0;
+        g->srcY = 0;
+        g->srcW = modeW;
+        g->srcH = modeH;
+    }
+    return true;
+}
+
+bool modelConfigValid(const ModelConfig_t& config) {
+    return config.size >= MODEL_SIZE_MIN && config.size <= MODEL_SIZE_MAX
+        && config.size % MODEL_SIZE_STEP == 0
+        && (config.fit == MODEL_FIT_CROP || config.fit == MODEL_FIT_PAD)
+        && motionGateFits(config.size, config.size);
+}
+
+framesize_t modelDriverFrameSize(const ModelConfig_t& config) {
+    ModelGeometry_t g;
+    int mode, scale;
+    if (!plan(config, &mode, &scale, &g)) return FRAMESIZE_VGA;
+    uint32_t area = (uint32_t)g.width * g.height;
+    for (int fs = FRAMESIZE_96X96; fs < FRAMESIZE_UXGA; fs++) {
+        if ((uint32_t)resolution[fs].width * resolution[fs].height >= area) return (framesize_t)fs;
+    }
+    return FRAMESIZE_UXGA;
+}
+
+bool modelModeBegin(const ModelConfig_t& config) {
+    geometry.active = false;
+    ModelGeometry_t g;
+    int mode, scale;
+    if (!plan(config, &mode, &scale, &g)) return false;
+
+    sensor_t* s = esp_camera_sensor_get();
+    if (!s || !s->set_res_raw) return false;
+    if (s->set_res_raw(s, mode, 0, 0, 0, g.srcX, g.srcY, g.srcW, g.srcH,
+                       g.width, g.height, true, true) != 0) {
+        return false;
+    }
+
+    // Report the source region in full-sensor pixels whatever the mode
+    g.srcX *= scale;
+    g.srcY *= scale;
+    g.srcW *= scale;
+    g.srcH *= scale;
+    geometry = g;
+    return true;
+}
+
+const ModelGeometry_t& modelGeometry() {
+    return geometry;
+}
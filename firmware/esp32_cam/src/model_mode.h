@@ -0,0 +1,64 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Model-Ready Output
+ * Frames sized for the backend's YOLO input, so the host does not decode
+ * VGA and then resize and letterbox every frame again.
+ *
+ * The OV2640 DSP can window and scale before the JPEG encoder, so the
+ * resize costs nothing here. Two fits:
+ *  - crop: centre square of the sensor, encoded at size x size; the
+ *          backend feeds it to the model as is
+ *  - pad:  full 4:3 view, encoded size wide; the backend pads the
+ *          declared border (one copy, no resize) to reach size x size
+ * Every part declares the geometry (X-Model-*) so boxes map back to the
+ * frame, or to the full sensor field, without a second pass. While the
+ * mode is on, rate control only steps JPEG quality; a frame size change
+ * would reset the window.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_camera.h"
+
+#define MODEL_SIZE_MIN          96
+#define MODEL_SIZE_MAX          1200    // Full sensor height (UXGA window)
+#define MODEL_SIZE_STEP         32      // YOLO stride
+
+typedef enum {
+    MODEL_FIT_CROP = 0,
+    MODEL_FIT_PAD = 1
+} ModelFit_t;
+
+// From Preferences (see main.cpp); size 0 = mode off
+typedef struct {
+    uint16_t size;
+    ModelFit_t fit;
+} ModelConfig_t;
+
+#define MODEL_CONFIG_DEFAULT { 0, MODEL_FIT_CROP }
+
+typedef struct {
+    bool active;
+    uint16_t size;              // Model input edge
+    uint16_t width;             // Encoded frame
+    uint16_t height;
+    uint16_t padX;              // Border to add on each side to reach size x size
+    uint16_t padY;
+    uint16_t srcX;              // Sensor region the frame shows, UXGA (1600x1200) pixels
+    uint16_t srcY;
+    uint16_t srcW;
+    uint16_t srcH;
+} ModelGeometry_t;
+
+bool modelConfigValid(const ModelConfig_t& config);
+
+// Smallest driver frame size whose buffers hold a frame of this geometry;
+// used as the camera_config_t frame_size when the mode is on
+framesize_t modelDriverFrameSize(const ModelConfig_t& config);
+
+// After esp_camera_init(): program the sensor window. False leaves the
+// sensor as initialised and the mode off.
+bool modelModeBegin(const ModelConfig_t& config);
+
+// Fixed from boot; active == false when the mode is off
+const ModelGeometry_t& modelGeometry();
@@ -0,0 +1,132 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Motion Gate
+ */
+
+#include "motion_gate.h"
+
+#include <string.h>
+
+// Per-cell gray sums during the pass, cell means after it
+static uint16_t cells[MOTION_MAX_PIXELS];
+static uint16_t background[MOTION_MAX_PIXELS];     // Q8, no dead band on slow drift
+static uint16_t bgWidth = 0, bgHeight = 0;     // 0 until the first frame primes it
+static uint32_t lastMotionMs = 0;
+
+// Current pass
+static uint16_t decodedW = 0, decodedH = 0;    // Decoder output
+static uint16_t gridW = 0, gridH = 0;          // Cells
+static uint8_t cellEdge = 1;                   // Decoded pixels per cell, each axis
+static bool oversize = false;                  // Grid larger than the buffers; tiles are dropped
+
+// Cell grid for a w x h frame at 1/8: the edge doubles up to
+// MOTION_MAX_SUBSAMPLE until it fits the buffers
+static uint8_t subsampleFor(uint16_t w, uint16_t h) {
+    uint8_t step = 1;
+    while ((uint32_t)((w + step - 1) / step) * ((h + step - 1) / step) > MOTION_MAX_PIXELS
+           && step < MOTION_MAX_SUBSAMPLE) {
+        step *= 2;
+    }
+    return step;
+}
+
+bool motionGateFits(uint16_t width, uint16_t height) {
+    uint16_t w = (width + 7) / 8, h = (height + 7) / 8;
+    uint8_t step = subsampleFor(w, h);
+    return (uint32_t)((w + step - 1) / step) * ((h + step - 1) / step) <= MOTION_MAX_PIXELS;
+}
+
+bool motionGateBegin(uint16_t width, uint16_t height, uint8_t scale) {
+    // A cell spans 8 sensor pixels (8 / scale decoded ones), times the
+    // large-frame subsample; at most 16 x 16 decoded pixels, so the sums
+    // fit 16 bits
+    uint8_t perEighth = (scale >= 8) ? 1 : 8 / scale;
+    uint16_t w8 = (width + perEighth - 1) / perEighth;
+    uint16_t h8 = (height + perEighth - 1) / perEighth;
+    cellEdge = perEighth * subsampleFor(w8, h8);
+    decodedW = width;
+    decodedH = height;
+    gridW = (width + cellEdge - 1) / cellEdge;
+    gridH = (height + cellEdge - 1) / cellEdge;
+    oversize = (uint32_t)gridW * gridH > MOTION_MAX_PIXELS;
+    if (!oversize) memset(cells, 0, (uint32_t)gridW * gridH * sizeof(cells[0]));
+    return !oversize;
+}
+
+// Decoded RGB888 tile into the cell sums; the channel order does not
+// matter for a change score, so R and B are weighted alike
+void motionGateTile(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t* rgb) {
+    if (oversize) return;
+    // Edge tiles are MCU sized and may reach past the declared output
+    for (uint16_t row = 0; row < h; row++) {
+        uint16_t sy = y + row;
+        if (sy >= decodedH) break;
+        uint16_t* out = &cells[(uint32_t)(sy / cellEdge) * gridW];
+        const uint8_t* in = rgb + (uint32_t)row * w * 3;
+        for (uint16_t col = 0; col < w; col++, in += 3) {
+            uint16_t sx = x + col;
+            if (sx >= decodedW) break;
+            out[sx / cellEdge] += (in[0] + 2 * in[1] + in[2]) >> 2;
+        }
+    }
+}
+
+// Sums to means; edge cells hold fewer pixels
+static void averageCells() {
+    for (uint16_t cy = 0; cy < gridH; cy++) {
+        uint16_t ch = decodedH - cy * cellEdge;
+        if (ch > cellEdge) ch = cellEdge;
+        for (uint16_t cx = 0; cx < gridW; cx++) {
+            uint16_t cw = decodedW - cx * cellEdge;
+            if (cw > cellEdge) cw = cellEdge;
+            uint16_t* c = &cells[(uint32_t)cy * gridW + cx];
+            *c /= (uint16_t)(cw * ch);
+        }
+    }
+}
+
+MotionResult_t motionGateFinish(bool decoded, uint32_t nowMs) {
+    MotionResult_t result = { 100, true };
+    if (!decoded || oversize || gridW == 0 || gridH == 0) {
+        lastMotionMs = nowMs;
+        return result;
+    }
+    averageCells();
+
+    // New geometry (rate control changed frame size): restart the background
+    if (gridW != bgWidth || gridH != bgHeight) {
+        for (uint32_t i = 0; i < (uint32_t)gridW * gridH; i++) background[i] = cells[i] << 8;
+        bgWidth = gridW;
+        bgHeight = gridH;
+        lastMotionMs = nowMs;
+        return result;
+    }
+
+    uint16_t blocksX = bgWidth / MOTION_BLOCK;
+    uint16_t blocksY = bgHeight / MOTION_BLOCK;
+    uint16_t changed = 0;
+    for (uint16_t by = 0; by < blocksY; by++) {
+        for (uint16_t bx = 0; bx < blocksX; bx++) {
+            uint32_t sad = 0;
+            for (uint16_t row = 0; row < MOTION_BLOCK; row++) {
+                uint32_t base = (by * MOTION_BLOCK + row) * bgWidth + bx * MOTION_BLOCK;
+                for (uint16_t col = 0; col < MOTION_BLOCK; col++) {
+                    int d = cells[base + col] - (background[base + col] >> 8);
+                    sad += (d < 0) ? -d : d;
+                }
+            }
+            if (sad >= MOTION_BLOCK_DIFF * MOTION_BLOCK * MOTION_BLOCK) changed++;
+        }
+    }
+
+    // Background follows slowly so lighting drift and parked objects fade in
+    uint32_t pixels = bgWidth * bgHeight;
+    for (uint32_t i = 0; i < pixels; i++) {
+        background[i] += (((int32_t)cells[i] << 8) - (int32_t)background[i]) >> MOTION_BG_SHIFT;
+    }
+
+    uint16_t blocks = blocksX * blocksY;
+    result.score = blocks ? (uint8_t)(changed * 100 / blocks) : 100;
+    if (result.score >= MOTION_SCORE_OPEN) lastMotionMs = nowMs;
+    result.active = (nowMs - lastMotionMs) < MOTION_HOLD_MS;
+    return result;
+}
@@ -0,0 +1,49 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Motion Gate
+ * Cheap scene-change score so an empty corridor is not JPEG-streamed and
+ * run through YOLO at full rate all day.
+ *
+ * The frame comes from the shared reduced-scale decode (frame_analysis.h)
+ * as grayscale and is averaged down to cells of 8x8 sensor pixels (80x60
+ * for VGA, the same grid a DC-only 1/8 decode gives). Above
+ * MOTION_MAX_PIXELS (XGA and up, model frames over 800) the cells are
+ * 16x16 sensor pixels. The image is split into MOTION_BLOCK cell blocks
+ * and each block's mean absolute difference against a running background
+ * (slow per-cell IIR) is compared with MOTION_BLOCK_DIFF. The score is the
+ * percentage of changed blocks. The gate is open while the score is at
+ * or above the threshold and for MOTION_HOLD_MS after; gated consumers
+ * then get full-rate frames, otherwise a keep-alive frame every
+ * MOTION_KEEPALIVE_MS.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_camera.h"
+
+#define MOTION_MAX_PIXELS       10000   // 1/8 scale of an 800x800 model frame (SVGA is 7500)
+#define MOTION_MAX_SUBSAMPLE    2       // Cell edge grows at most this much: UXGA 100x75, 1200 model 75x75
+#define MOTION_BLOCK            8       // Block edge in cells (64 sensor px, 128 for large frames)
+#define MOTION_BLOCK_DIFF       12      // Mean |frame - background| for a changed block
+#define MOTION_SCORE_OPEN       3       // % of blocks changed that opens the gate
+#define MOTION_BG_SHIFT         4       // Background follows 1/16 of each new frame
+#define MOTION_HOLD_MS          3000    // Stay open this long after the last motion
+#define MOTION_KEEPALIVE_MS     5000    // Gated consumers still get a frame this often
+
+typedef struct {
+    uint8_t score;              // % of blocks changed, 0-100
+    bool active;                // Gate open (motion now or within the hold)
+} MotionResult_t;
+
+// One decode pass (frame_analysis.cpp, capture task). begin() gets the
+// decoder's output size and its scale (1, 2, 4 or 8 sensor pixels per
+// decoded pixel); false when the frame does not fit even in large cells,
+// and the pass's tiles are then ignored. finish() scores the frame;
+// frames that did not decode or fit count as motion, so nothing is lost.
+bool motionGateBegin(uint16_t width, uint16_t height, uint8_t scale);
+void motionGateTile(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint8_t* rgb);
+MotionResult_t motionGateFinish(bool decoded, uint32_t nowMs);
+
+// Whether a width x height frame decodes into the buffers; frame sizes
+// that do not are rejected at configuration time
+bool motionGateFits(uint16_t width, uint16_t height);
@@ -0,0 +1,180 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Push Client
+ */
+
+#include "push_client.h"
+
+#include <Arduino.h>
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+#include "frame_hub.h"
+#include "hazard_filter.h"
+#include "motion_gate.h"
+#include "rate_control.h"
+#include "stream_server.h"
+
+static char pushHost[64];
+static uint16_t pushPort = PUSH_PORT_DEFAULT;
+static char device[32];
+static PushStats_t stats;
+static portMUX_TYPE pushLock = portMUX_INITIALIZER_UNLOCKED;
+
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// Non-blocking connect bounded by PUSH_CONNECT_TIMEOUT_MS; lwIP's own
+// SYN retries would otherwise hold the task for a long time
+static int connectServer() {
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char port[8];
+    snprintf(port, sizeof(port), "%u", pushPort);
+    if (getaddrinfo(pushHost, port, &hints, &res) != 0 || !res) return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return -1;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int rc = connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc != 0 && errno != EINPROGRESS) {
+        close(fd);
+        return -1;
+    }
+    if (rc != 0) {
+        fd_set wfds;
+        FD_ZERO(&wfds);
+        FD_SET(fd, &wfds);
+        struct timeval tv = { PUSH_CONNECT_TIMEOUT_MS / 1000, (PUSH_CONNECT_TIMEOUT_MS % 1000) * 1000 };
+        int err = 0;
+        socklen_t errLen = sizeof(err);
+        if (select(fd + 1, NULL, &wfds, NULL, &tv) != 1
+            || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) != 0 || err != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    fcntl(fd, F_SETFL, flags);
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    struct timeval sendTimeout = { PUSH_SEND_TIMEOUT_S, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+    return fd;
+}
+
+// Sends until the connection fails
+static void pushFrames(int fd) {
+    uint8_t head[4 + FRAME_HEADERS_MAX + 4];
+    char* meta = (char*)head + 4;
+
+    int metaLen = snprintf(meta, FRAME_HEADERS_MAX, "X-Device: %s\r\n", device);
+    putU32(head, metaLen);
+    putU32(head + 4 + metaLen, 0);
+    if (!streamSendAll(fd, head, 4 + metaLen + 4)) return;
+
+    if (!frameHubSubscribe(xTaskGetCurrentTaskHandle())) return;
+    uint32_t lastSeq = 0;
+    uint32_t lastSentMs = millis() - MOTION_KEEPALIVE_MS;
+    uint32_t prevSendMs = 0;
+    uint32_t gatedSince = 0;
+    while (true) {
+        Frame_t* frame = frameHubAcquire(lastSeq, 1000);
+        if (!frame) continue;
+        uint32_t missed = (lastSeq && frame->seq - lastSeq > 1) ? frame->seq - lastSeq - 1 : 0;
+        lastSeq = frame->seq;
+        if (missed) {
+            portENTER_CRITICAL(&pushLock);
+            stats.dropped += missed;
+            portEXIT_CRITICAL(&pushLock);
+        }
+
+        if (!frame->active && frameHazard(frame) < HAZARD_LIKELY
+            && millis() - lastSentMs < MOTION_KEEPALIVE_MS) {
+            frameHubRelease(frame);
+            portENTER_CRITICAL(&pushLock);
+            stats.gatedFrames++;
+            portEXIT_CRITICAL(&pushLock);
+            gatedSince++;
+            continue;
+        }
+
+        camera_fb_t* fb = frame->fb;
+        metaLen = frameFormatHeaders(frame, prevSendMs, gatedSince, meta, FRAME_HEADERS_MAX);
+        putU32(head, metaLen);
+        putU32(head + 4 + metaLen, fb->len);
+        size_t frameLen = fb->len;
+        uint32_t ageMs = frameAgeMs(frame);
+        uint32_t sendStart = millis();
+        struct iovec iov[2] = {
+            { head, (size_t)(4 + metaLen + 4) },
+            { fb->buf, fb->len },
+        };
+        bool ok = streamSendAllv(fd, iov, 2);
+        frameHubRelease(frame);
+        if (!ok) break;
+        lastSentMs = millis();
+        prevSendMs = lastSentMs - sendStart;
+        gatedSince = 0;
+        rateControlReport(RATE_LINK_PUSH, prevSendMs, ageMs);
+
+        portENTER_CRITICAL(&pushLock);
+        stats.frames++;
+        stats.bytes += frameLen + metaLen + 8;
+        portEXIT_CRITICAL(&pushLock);
+    }
+    frameHubUnsubscribe(xTaskGetCurrentTaskHandle());
+}
+
+static void pushTask(void* parameter) {
+    uint32_t backoffMs = PUSH_BACKOFF_MIN_MS;
+    while (true) {
+        int fd = connectServer();
+        if (fd < 0) {
+            delay(backoffMs);
+            backoffMs = min<uint32_t>(backoffMs * 2, PUSH_BACKOFF_MAX_MS);
+            continue;
+        }
+        backoffMs = PUSH_BACKOFF_MIN_MS;
+        Serial.printf("Push connected to %s:%u\n", pushHost, pushPort);
+        portENTER_CRITICAL(&pushLock);
+        stats.connected = true;
+        stats.connects++;
+        portEXIT_CRITICAL(&pushLock);
+
+        pushFrames(fd);
+
+        close(fd);
+        portENTER_CRITICAL(&pushLock);
+        stats.connected = false;
+        portEXIT_CRITICAL(&pushLock);
+        Serial.println("Push connection lost");
+        delay(backoffMs);
+    }
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+bool pushClientStart(const char* host, uint16_t port, const char* deviceId) {
+    strlcpy(pushHost, host, sizeof(pushHost));
+    strlcpy(device, deviceId, sizeof(device));
+    pushPort = port;
+    return xTaskCreate(pushTask, "push", PUSH_TASK_STACK, NULL, PUSH_TASK_PRIORITY, NULL) == pdPASS;
+}
+
+PushStats_t pushClientStats() {
+    portENTER_CRITICAL(&pushLock);
+    PushStats_t copy = stats;
+    portEXIT_CRITICAL(&pushLock);
+    return copy;
+}
@@ -0,0 +1,42 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Push Client
+ * Streams frames to the provisioned server_ip over one persistent TCP
+ * connection, so the backend needs no route to the camera (NAT, AP
+ * isolation) and a reconnect costs one handshake instead of a new pull.
+ *
+ * Wire format, one message per frame (big-endian lengths):
+ *   [u32 meta_len][meta][u32 jpeg_len][jpeg]
+ * meta is the same "X-Name: value\r\n" lines an MJPEG part carries
+ * (frameFormatHeaders). The first message after connecting is a hello
+ * with X-Device and no JPEG. Frames come straight from the frame hub, so
+ * at most the one frame being sent is buffered; anything captured
+ * meanwhile is superseded, never queued. The motion gate applies as for
+ * a default /stream client. A lost connection is retried with
+ * exponential backoff, and capture stops while nothing is connected.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define PUSH_PORT_DEFAULT       5558
+#define PUSH_TASK_STACK         4096
+#define PUSH_TASK_PRIORITY      5       // Same as the stream senders
+#define PUSH_CONNECT_TIMEOUT_MS 3000
+#define PUSH_SEND_TIMEOUT_S     5
+#define PUSH_BACKOFF_MIN_MS     500
+#define PUSH_BACKOFF_MAX_MS     30000
+
+typedef struct {
+    bool connected;
+    uint32_t connects;          // Successful connections since boot
+    uint32_t frames;
+    uint32_t gatedFrames;
+    uint32_t dropped;           // Captured while a send was in progress (X-Seq gaps)
+    uint64_t bytes;
+} PushStats_t;
+
+// host: server_ip from provisioning (address or name)
+bool pushClientStart(const char* host, uint16_t port, const char* deviceId);
+
+PushStats_t pushClientStats();
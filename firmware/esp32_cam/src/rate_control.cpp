@@ -0,0 +1,153 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Adaptive Rate Control
+ */
+
+#include "rate_control.h"
+
+#include <Arduino.h>
+
+// Same-aspect sizes the controller may step between (sensor native 4:3)
+static const framesize_t SIZE_LADDER[] = {
+    FRAMESIZE_QQVGA, FRAMESIZE_QVGA, FRAMESIZE_VGA, FRAMESIZE_SVGA, FRAMESIZE_XGA, FRAMESIZE_UXGA
+};
+#define SIZE_LADDER_LEN ((int)(sizeof(SIZE_LADDER) / sizeof(SIZE_LADDER[0])))
+
+static RateConfig_t cfg = RATE_CONFIG_DEFAULT;
+static RateState_t state;
+static uint32_t periodStartMs = 0;
+static uint32_t calmPeriods = 0;
+static int ladderPos = -1;              // -1: size is off the ladder and stays fixed
+static int ladderLo = 0, ladderHi = 0;  // Ladder span within sizeMin..sizeMax
+
+// Per-period accumulators per link, written by the senders
+static uint32_t sendSum[RATE_MAX_LINKS], ageSum[RATE_MAX_LINKS], reports[RATE_MAX_LINKS];
+static portMUX_TYPE rateLock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t midQuality() {
+    return (cfg.qualityBest + cfg.qualityWorst) / 2;
+}
+
+static void apply(uint8_t quality, framesize_t size) {
+    sensor_t* s = esp_camera_sensor_get();
+    if (!s) return;
+    if (size != state.size) s->set_framesize(s, size);
+    if (quality != state.quality) s->set_quality(s, quality);
+
+    portENTER_CRITICAL(&rateLock);
+    state.quality = quality;
+    state.size = size;
+    state.steps++;
+    portEXIT_CRITICAL(&rateLock);
+}
+
+void rateControlBegin(const RateConfig_t& config, uint8_t quality, framesize_t size) {
+    cfg = config;
+    if (cfg.targetFps == 0) cfg.targetFps = 1;
+    if (cfg.targetLatencyMs == 0) cfg.targetLatencyMs = 1;
+    state.quality = quality;
+    state.size = size;
+    state.sendMs = 0.0f;
+    state.ageMs = 0.0f;
+    state.steps = 0;
+    state.links = 0;
+    periodStartMs = millis();
+    calmPeriods = 0;
+
+    ladderPos = -1;
+    for (int i = 0; i < SIZE_LADDER_LEN; i++) {
+        if (SIZE_LADDER[i] == size) ladderPos = i;
+    }
+    ladderLo = ladderHi = ladderPos;
+    if (ladderPos < 0) return;
+    while (ladderLo > 0 && SIZE_LADDER[ladderLo - 1] >= cfg.sizeMin) ladderLo--;
+    while (ladderHi < SIZE_LADDER_LEN - 1 && SIZE_LADDER[ladderHi + 1] <= cfg.sizeMax) ladderHi++;
+}
+
+void rateControlReport(uint8_t link, uint32_t sendMs, uint32_t ageMs) {
+    if (link >= RATE_MAX_LINKS) return;
+    portENTER_CRITICAL(&rateLock);
+    sendSum[link] += sendMs;
+    ageSum[link] += ageMs;
+    reports[link]++;
+    portEXIT_CRITICAL(&rateLock);
+}
+
+void rateControlTick(uint32_t nowMs) {
+    if (nowMs - periodStartMs < RATE_PERIOD_MS) return;
+    periodStartMs = nowMs;
+
+    uint32_t send[RATE_MAX_LINKS], age[RATE_MAX_LINKS], n[RATE_MAX_LINKS];
+    portENTER_CRITICAL(&rateLock);
+    memcpy(send, sendSum, sizeof(send));
+    memcpy(age, ageSum, sizeof(age));
+    memcpy(n, reports, sizeof(n));
+    memset(sendSum, 0, sizeof(sendSum));
+    memset(ageSum, 0, sizeof(ageSum));
+    memset(reports, 0, sizeof(reports));
+    portEXIT_CRITICAL(&rateLock);
+
+    // Best-served link: lowest load against the frame budget or latency target
+    float budgetMs = 1000.0f / cfg.targetFps;
+    float sendMs = 0.0f, ageMs = 0.0f, bestLoad = 0.0f;
+    uint8_t links = 0;
+    for (int i = 0; i < RATE_MAX_LINKS; i++) {
+        if (n[i] == 0) continue;
+        float s = (float)send[i] / n[i];
+        float a = (float)age[i] / n[i];
+        float load = max(s / budgetMs, a / cfg.targetLatencyMs);
+        if (links++ == 0 || load < bestLoad) {
+            bestLoad = load;
+            sendMs = s;
+            ageMs = a;
+        }
+    }
+    if (links == 0) return;     // Nobody streaming, nothing to learn
+
+    portENTER_CRITICAL(&rateLock);
+    state.sendMs = sendMs;
+    state.ageMs = ageMs;
+    state.links = links;
+    portEXIT_CRITICAL(&rateLock);
+
+    uint8_t q = state.quality;
+    framesize_t size = state.size;
+
+    if (sendMs > budgetMs * RATE_OVER_BUDGET || ageMs > cfg.targetLatencyMs) {
+        calmPeriods = 0;
+        if (q < cfg.qualityWorst) {
+            q = min<int>(q + RATE_QUALITY_STEP, cfg.qualityWorst);
+        } else if (ladderPos > ladderLo) {
+            size = SIZE_LADDER[--ladderPos];
+            q = midQuality();
+        } else {
+            return;             // Already at the floor
+        }
+        apply(q, size);
+        return;
+    }
+
+    if (sendMs < budgetMs * RATE_UNDER_BUDGET && ageMs < cfg.targetLatencyMs / 2) {
+        if (++calmPeriods < RATE_UP_PERIODS) return;
+        calmPeriods = 0;
+        if (q > cfg.qualityBest) {
+            q = max<int>(q - RATE_QUALITY_STEP, cfg.qualityBest);
+        } else if (ladderPos >= 0 && ladderPos < ladderHi) {
+            size = SIZE_LADDER[++ladderPos];
+            q = midQuality();
+        } else {
+            return;
+        }
+        apply(q, size);
+        return;
+    }
+
+    calmPeriods = 0;
+}
+
+RateState_t rateControlState() {
+    RateState_t s;
+    portENTER_CRITICAL(&rateLock);
+    s = state;
+    portEXIT_CRITICAL(&rateLock);
+    return s;
+}
@@ -0,0 +1,71 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Adaptive Rate Control
+ * Trades JPEG quality, then frame size, against link capacity so frames
+ * keep arriving at the target rate with bounded latency instead of
+ * backing up on a congested Wi-Fi link.
+ *
+ * Senders report how long each frame took to send and how old it was
+ * when sending started (capture-to-wire time, i.e. the backlog ahead of
+ * it; lwIP does not expose the socket send queue). Once per
+ * RATE_PERIOD_MS the capture task compares the period means against the
+ * frame budget (1000 / target fps) and the latency target:
+ *  - over budget:  quality down one step; at the quality floor, one frame
+ *                  size down with quality back to mid-range
+ *  - well under:   after RATE_UP_PERIODS calm periods, the reverse
+ * Changes are applied to the sensor from the capture task.
+ *
+ * Frame sizes step along the 4:3 ladder QQVGA, QVGA, VGA, SVGA, XGA,
+ * UXGA only, so the motion gate background and detector geometry keep
+ * their aspect ratio. A driver started at any other size (HD, SXGA,
+ * square, CIF...) keeps it and only quality adapts.
+ *
+ * The encoder settings are shared by every consumer (one capture), so
+ * each link reports on its own and a step follows the best-served one.
+ * A link slower than that gets fewer frames (X-Seq gaps) rather than
+ * lowering quality for everyone.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_camera.h"
+
+#define RATE_PERIOD_MS          1000
+#define RATE_UP_PERIODS         5       // Calm periods before stepping quality back up
+#define RATE_QUALITY_STEP       4
+#define RATE_OVER_BUDGET        0.9f    // Mean send time above this share of the budget = congested
+#define RATE_UNDER_BUDGET       0.5f    // Below this share (and latency met) = headroom
+#define RATE_MAX_LINKS          6       // Stream sender slots, then the push client
+#define RATE_LINK_PUSH          (RATE_MAX_LINKS - 1)
+
+// Bounds and targets, from Preferences (see main.cpp)
+typedef struct {
+    uint8_t targetFps;
+    uint16_t targetLatencyMs;   // Capture to start of send
+    uint8_t qualityBest;        // Lowest jpeg_quality value allowed (best image)
+    uint8_t qualityWorst;       // Highest jpeg_quality value allowed
+    framesize_t sizeMin;
+    framesize_t sizeMax;        // Must not exceed the size the driver was initialised with
+} RateConfig_t;
+
+#define RATE_CONFIG_DEFAULT { 10, 300, 10, 40, FRAMESIZE_QVGA, FRAMESIZE_VGA }
+
+typedef struct {
+    uint8_t quality;
+    framesize_t size;
+    float sendMs;               // Last period means of the best-served link
+    float ageMs;
+    uint8_t links;              // Links that reported in the last period
+    uint32_t steps;             // Adjustments made since boot
+} RateState_t;
+
+void rateControlBegin(const RateConfig_t& config, uint8_t quality, framesize_t size);
+
+// From sender tasks, once per frame sent; link is the stream client slot
+// or RATE_LINK_PUSH
+void rateControlReport(uint8_t link, uint32_t sendMs, uint32_t ageMs);
+
+// From the capture task, every frame; adjusts the sensor at most once per period
+void rateControlTick(uint32_t nowMs);
+
+RateState_t rateControlState();
@@ -0,0 +1,470 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Stream Server
+ */
+
+#include "stream_server.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <lwip/sockets.h>
+#include "cpu_load.h"
+#include "event_ring.h"
+#include "frame_hub.h"
+#include "hazard_filter.h"
+#include "model_mode.h"
+#include "motion_gate.h"
+#include "push_client.h"
+#include "rate_control.h"
+
+static const char STREAM_HEAD[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n";
+
+// Constant start of every part; each sender keeps it in its header buffer
+// and only writes the length and metadata after it per frame
+static const char PART_PREFIX[] =
+    "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: ";
+#define PART_PREFIX_LEN (sizeof(PART_PREFIX) - 1)
+
+static_assert(STREAM_MAX_CLIENTS <= RATE_LINK_PUSH, "client slots double as rate control links");
+static const char PART_TRAILER[] = "\r\n";
+
+// ============================================================================
+// CLIENT TABLE
+// A slot is free once its sender has stopped and httpd has closed the
+// session; either side may finish first. httpd never closes a socket a
+// sender is still writing to (onSocketClose): the number could otherwise
+// be reused by a new connection mid-frame and get the rest of the part.
+// ============================================================================
+typedef struct {
+    bool running;               // Sender task alive
+    bool sessionOpen;           // httpd still owns an open socket
+    bool closeDeferred;         // httpd is done with it; the sender closes the fd
+    int fd;
+    StreamClientInfo_t info;
+    uint32_t windowStartMs;
+    uint32_t windowFrames;
+} StreamClient_t;
+
+// Other modules' request sockets written from their own task; same rule
+typedef struct {
+    bool held;
+    bool closeDeferred;
+    int fd;
+} HeldSocket_t;
+
+static httpd_handle_t server = NULL;
+static StreamClient_t clients[STREAM_MAX_CLIENTS];
+static HeldSocket_t heldSockets[STREAM_HELD_SOCKETS];
+static portMUX_TYPE clientsLock = portMUX_INITIALIZER_UNLOCKED;
+
+static int claimSlot(int fd) {
+    int slot = -1;
+    portENTER_CRITICAL(&clientsLock);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (!clients[i].running && !clients[i].sessionOpen) {
+            clients[i].running = true;
+            clients[i].sessionOpen = true;
+            clients[i].closeDeferred = false;
+            clients[i].fd = fd;
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&clientsLock);
+    return slot;
+}
+
+// httpd session free callback: the socket is closed (client went away or
+// the sender asked for it)
+static void onSessionClosed(void* ctx) {
+    StreamClient_t* c = (StreamClient_t*)ctx;
+    portENTER_CRITICAL(&clientsLock);
+    c->sessionOpen = false;
+    portEXIT_CRITICAL(&clientsLock);
+}
+
+// httpd close_fn for every session socket. A stream socket whose sender
+// is still running, or a held one, is left open for its task to close
+// once it stops.
+static void onSocketClose(httpd_handle_t hd, int fd) {
+    bool deferred = false;
+    portENTER_CRITICAL(&clientsLock);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++) {
+        if (clients[i].running && clients[i].fd == fd && !clients[i].closeDeferred) {
+            clients[i].sessionOpen = false;
+            clients[i].closeDeferred = true;
+            deferred = true;
+            break;
+        }
+    }
+    for (int i = 0; i < STREAM_HELD_SOCKETS && !deferred; i++) {
+        if (heldSockets[i].held && heldSockets[i].fd == fd && !heldSockets[i].closeDeferred) {
+            heldSockets[i].closeDeferred = true;
+            deferred = true;
+        }
+    }
+    portEXIT_CRITICAL(&clientsLock);
+    if (!deferred) close(fd);
+}
+
+bool streamSendAll(int fd, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len > 0) {
+        int n = send(fd, p, len, 0);
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// One writev hands lwIP a whole part at once instead of small segments
+bool streamSendAllv(int fd, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n <= 0) return false;
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+// Decimal digits of v followed by CRLF; returns the length written
+static int putLength(char* p, uint32_t v) {
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    for (int i = 0; i < n; i++) p[i] = digits[n - 1 - i];
+    p[n] = '\r';
+    p[n + 1] = '\n';
+    return n + 2;
+}
+
+// ============================================================================
+// SENDER TASK (one per /stream client)
+// ============================================================================
+static void senderTask(void* arg) {
+    StreamClient_t* c = (StreamClient_t*)arg;
+    int fd = c->fd;
+    char head[PART_PREFIX_LEN + 12 + FRAME_HEADERS_MAX + 2];
+    memcpy(head, PART_PREFIX, PART_PREFIX_LEN);
+    uint32_t lastSeq = 0;
+    uint32_t prevSendMs = 0;
+    uint32_t gatedSince = 0;
+    uint32_t lastSentMs = millis() - MOTION_KEEPALIVE_MS;     // First frame always goes out
+    bool gated = c->info.gated;
+    bool subscribed = frameHubSubscribe(xTaskGetCurrentTaskHandle());
+
+    while (subscribed) {
+        bool open;
+        portENTER_CRITICAL(&clientsLock);
+        open = c->sessionOpen;
+        portEXIT_CRITICAL(&clientsLock);
+        if (!open) break;
+
+        // Shared, reference-counted frame from the capture task
+        Frame_t* frame = frameHubAcquire(lastSeq, 1000);
+        if (!frame) continue;
+        // Captured while this client was still busy with an earlier one
+        uint32_t missed = (lastSeq && frame->seq - lastSeq > 1) ? frame->seq - lastSeq - 1 : 0;
+        lastSeq = frame->seq;
+        camera_fb_t* fb = frame->fb;
+        if (missed) {
+            portENTER_CRITICAL(&clientsLock);
+            c->info.dropped += missed;
+            portEXIT_CRITICAL(&clientsLock);
+        }
+
+        // Quiet scene: only a keep-alive now and then. A likely fire or
+        // smoke frame always goes out, even if the scene is static.
+        if (gated && !frame->active && frameHazard(frame) < HAZARD_LIKELY
+            && millis() - lastSentMs < MOTION_KEEPALIVE_MS) {
+            frameHubRelease(frame);
+            portENTER_CRITICAL(&clientsLock);
+            c->info.gatedFrames++;
+            portEXIT_CRITICAL(&clientsLock);
+            gatedSince++;
+            continue;
+        }
+
+        // Prefix stays in place; length, encoder settings and analysis
+        // are written after it
+        int headLen = PART_PREFIX_LEN;
+        headLen += putLength(head + headLen, fb->len);
+        headLen += frameFormatHeaders(frame, prevSendMs, gatedSince, head + headLen, sizeof(head) - headLen - 2);
+        head[headLen++] = '\r';
+        head[headLen++] = '\n';
+        size_t frameLen = fb->len;
+        uint32_t ageMs = frameAgeMs(frame);
+        uint32_t sendStart = millis();
+        struct iovec iov[3] = {
+            { head, (size_t)headLen },
+            { fb->buf, fb->len },
+            { (void*)PART_TRAILER, sizeof(PART_TRAILER) - 1 },
+        };
+        bool ok = streamSendAllv(fd, iov, 3);
+        frameHubRelease(frame);
+        if (!ok) break;
+        lastSentMs = millis();
+        prevSendMs = lastSentMs - sendStart;
+        gatedSince = 0;
+        rateControlReport((uint8_t)(c - clients), prevSendMs, ageMs);
+
+        uint32_t now = millis();
+        portENTER_CRITICAL(&clientsLock);
+        c->info.frames++;
+        c->info.bytes += headLen + frameLen + 2;
+        c->windowFrames++;
+        if (now - c->windowStartMs >= 1000) {
+            c->info.fps = c->windowFrames * 1000.0f / (now - c->windowStartMs);
+            c->windowFrames = 0;
+            c->windowStartMs = now;
+        }
+        portEXIT_CRITICAL(&clientsLock);
+    }
+
+    if (subscribed) frameHubUnsubscribe(xTaskGetCurrentTaskHandle());
+    Serial.printf("Stream client %d done: %u frames, %.1f fps\n",
+                  (int)(c - clients), (unsigned)c->info.frames, c->info.fps);
+
+    bool closeSession, closeFd;
+    portENTER_CRITICAL(&clientsLock);
+    c->running = false;
+    closeSession = c->sessionOpen;
+    closeFd = c->closeDeferred;
+    portEXIT_CRITICAL(&clientsLock);
+    if (closeFd) {
+        close(fd);
+    } else if (closeSession) {
+        httpd_sess_trigger_close(server, fd);
+    }
+
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// HANDLERS
+// ============================================================================
+static esp_err_t handleStream(httpd_req_t* req) {
+    int fd = httpd_req_to_sockfd(req);
+    int slot = claimSlot(fd);
+    if (slot < 0) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "stream client limit reached");
+        return ESP_OK;
+    }
+    StreamClient_t* c = &clients[slot];
+
+    // Built aside; /stats reads the slot under the lock
+    StreamClientInfo_t info;
+    memset(&info, 0, sizeof(info));
+    struct sockaddr_in peer;
+    socklen_t peerLen = sizeof(peer);
+    if (getpeername(fd, (struct sockaddr*)&peer, &peerLen) == 0) info.ip = peer.sin_addr.s_addr;
+    info.connectedMs = millis();
+    info.gated = true;
+    char query[32], value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK
+        && httpd_query_key_value(query, "gate", value, sizeof(value)) == ESP_OK) {
+        info.gated = strcmp(value, "0") != 0;
+    }
+    portENTER_CRITICAL(&clientsLock);
+    c->info = info;
+    c->windowStartMs = info.connectedMs;
+    c->windowFrames = 0;
+    portEXIT_CRITICAL(&clientsLock);
+
+    // httpd keeps the socket; closing the session tells the sender to stop
+    req->sess_ctx = c;
+    req->free_ctx = onSessionClosed;
+
+    // Each part goes out as one writev; do not hold its tail back for
+    // Nagle. The send buffer itself is lwIP's compile-time TCP_SND_BUF
+    // (no SO_SNDBUF in this stack).
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    bool started = streamSendAll(fd, STREAM_HEAD, sizeof(STREAM_HEAD) - 1)
+                && xTaskCreate(senderTask, "stream", STREAM_TASK_STACK, c,
+                               STREAM_TASK_PRIORITY, NULL) == pdPASS;
+    if (!started) {
+        portENTER_CRITICAL(&clientsLock);
+        c->running = false;
+        portEXIT_CRITICAL(&clientsLock);
+        return ESP_FAIL;        // httpd closes the session
+    }
+
+    Serial.printf("Stream client %d connected\n", slot);
+    return ESP_OK;
+}
+
+// {"clients":[{"ip":"..","fps":..,"frames":..,"kbytes":..,"uptime_s":..,"gated":..,"gated_frames":..,"dropped":..}],
+//  "rate":{"quality":..,"framesize":..,"send_ms":..,"age_ms":..,"links":..,"steps":..},
+//  "analysis":{"us":..,"max_us":..},
+//  "model":{"size":..,"width":..,"height":..,"pad":[x,y],"src":[x,y,w,h]},   (model mode only)
+//  "push":{"connected":..,"connects":..,"frames":..,"gated_frames":..,"dropped":..,"kbytes":..},
+//  "ring":{"frozen":..,"frames":..,"kbytes":..,"capacity_kb":..,"span_ms":..},   (PSRAM ring only)
+//  "capture":{"fps":..,"frames":..,"driver_misses":..,"superseded":..,"latest_drops":..},
+//  "heap":{"free":..,"min_free":..,"psram_free":..},"uptime_s":..,
+//  "cpu":[core0 %,core1 %]}   (bench builds only, cpu_load.h)
+static esp_err_t handleStats(httpd_req_t* req) {
+    StreamClientInfo_t list[STREAM_MAX_CLIENTS];
+    uint8_t n = streamClients(list, STREAM_MAX_CLIENTS);
+    uint32_t now = millis();
+    RateState_t rate = rateControlState();
+
+    StaticJsonDocument<2048> doc;
+    JsonArray arr = doc.createNestedArray("clients");
+    for (uint8_t i = 0; i < n; i++) {
+        JsonObject o = arr.createNestedObject();
+        o["ip"] = IPAddress(list[i].ip).toString();
+        o["fps"] = list[i].fps;
+        o["frames"] = list[i].frames;
+        o["kbytes"] = (uint32_t)(list[i].bytes / 1024);
+        o["uptime_s"] = (now - list[i].connectedMs) / 1000;
+        o["gated"] = list[i].gated;
+        o["gated_frames"] = list[i].gatedFrames;
+        o["dropped"] = list[i].dropped;
+    }
+    JsonObject r = doc.createNestedObject("rate");
+    r["quality"] = rate.quality;
+    r["framesize"] = (int)rate.size;
+    r["send_ms"] = rate.sendMs;
+    r["age_ms"] = rate.ageMs;
+    r["links"] = rate.links;
+    r["steps"] = rate.steps;
+    FrameHubStats_t hub = frameHubStats();
+    JsonObject a = doc.createNestedObject("analysis");
+    a["us"] = hub.analysisUs;
+    a["max_us"] = hub.maxUs;
+    const ModelGeometry_t& model = modelGeometry();
+    if (model.active) {
+        JsonObject m = doc.createNestedObject("model");
+        m["size"] = model.size;
+        m["width"] = model.width;
+        m["height"] = model.height;
+        JsonArray pad = m.createNestedArray("pad");
+        pad.add(model.padX);
+        pad.add(model.padY);
+        JsonArray src = m.createNestedArray("src");
+        src.add(model.srcX);
+        src.add(model.srcY);
+        src.add(model.srcW);
+        src.add(model.srcH);
+    }
+    PushStats_t push = pushClientStats();
+    JsonObject p = doc.createNestedObject("push");
+    p["connected"] = push.connected;
+    p["connects"] = push.connects;
+    p["frames"] = push.frames;
+    p["gated_frames"] = push.gatedFrames;
+    p["dropped"] = push.dropped;
+    p["kbytes"] = (uint32_t)(push.bytes / 1024);
+    EventRingStats_t ring = eventRingStats();
+    if (ring.enabled) {
+        JsonObject e = doc.createNestedObject("ring");
+        e["frozen"] = ring.frozen;
+        e["frames"] = ring.frames;
+        e["kbytes"] = ring.bytes / 1024;
+        e["capacity_kb"] = ring.capacityBytes / 1024;
+        e["span_ms"] = ring.spanMs;
+    }
+    JsonObject cap = doc.createNestedObject("capture");
+    cap["fps"] = hub.fps;
+    cap["frames"] = hub.captured;
+    cap["driver_misses"] = hub.driverMisses;
+    cap["superseded"] = hub.superseded;
+    cap["latest_drops"] = hub.latestDrops;
+    JsonObject heap = doc.createNestedObject("heap");
+    heap["free"] = ESP.getFreeHeap();
+    heap["min_free"] = ESP.getMinFreeHeap();
+    heap["psram_free"] = ESP.getFreePsram();
+    doc["uptime_s"] = now / 1000;
+    if (cpuLoadAvailable()) {
+        JsonArray cpu = doc.createNestedArray("cpu");
+        cpu.add(cpuLoadPercent(0));
+        cpu.add(cpuLoadPercent(1));
+    }
+
+    char body[2048];
+    size_t len = serializeJson(doc, body, sizeof(body));
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, body, len);
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+httpd_handle_t streamServerStart() {
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = STREAM_PORT;
+    config.max_open_sockets = STREAM_MAX_CLIENTS + 3;
+    config.send_wait_timeout = STREAM_SEND_TIMEOUT_S;
+    config.stack_size = STREAM_HTTPD_STACK;
+    config.lru_purge_enable = false;    // Never evict a streaming socket
+    config.close_fn = onSocketClose;
+
+    if (httpd_start(&server, &config) != ESP_OK) return NULL;
+
+    httpd_uri_t stream = { "/stream", HTTP_GET, handleStream, NULL };
+    httpd_uri_t stats = { "/stats", HTTP_GET, handleStats, NULL };
+    httpd_register_uri_handler(server, &stream);
+    httpd_register_uri_handler(server, &stats);
+    return server;
+}
+
+bool streamSocketHold(int fd) {
+    bool held = false;
+    portENTER_CRITICAL(&clientsLock);
+    for (int i = 0; i < STREAM_HELD_SOCKETS && !held; i++) {
+        if (!heldSockets[i].held) {
+            heldSockets[i].held = true;
+            heldSockets[i].closeDeferred = false;
+            heldSockets[i].fd = fd;
+            held = true;
+        }
+    }
+    portEXIT_CRITICAL(&clientsLock);
+    return held;
+}
+
+void streamSocketRelease(int fd) {
+    bool found = false, closeFd = false;
+    portENTER_CRITICAL(&clientsLock);
+    for (int i = 0; i < STREAM_HELD_SOCKETS && !found; i++) {
+        if (heldSockets[i].held && heldSockets[i].fd == fd) {
+            heldSockets[i].held = false;
+            closeFd = heldSockets[i].closeDeferred;
+            found = true;
+        }
+    }
+    portEXIT_CRITICAL(&clientsLock);
+    if (closeFd) {
+        close(fd);
+    } else if (found) {
+        httpd_sess_trigger_close(server, fd);
+    }
+}
+
+uint8_t streamClients(StreamClientInfo_t* out, uint8_t max) {
+    uint8_t n = 0;
+    portENTER_CRITICAL(&clientsLock);
+    for (int i = 0; i < STREAM_MAX_CLIENTS && n < max; i++) {
+        if (clients[i].running && clients[i].sessionOpen) out[n++] = clients[i].info;
+    }
+    portEXIT_CRITICAL(&clientsLock);
+    return n;
+}
@@ -0,0 +1,58 @@
+/**
+ * MOD-EVAC-MS - ESP32-CAM Stream Server
+ * esp_http_server on port 81 serving /stream (MJPEG) and /stats, with
+ * /config registered by main.cpp.
+ *
+ * The HTTP server task only accepts a /stream request, writes the
+ * multipart response head and hands the socket to a sender task of its
+ * own, so the backend vision_worker, dashboard viewers and /config are
+ * all served at the same time. Senders take frames from the shared
+ * capture task (frame_hub.h) and measure their client's frame rate over
+ * one-second windows. Unless a client asks for /stream?gate=0, a quiet
+ * scene is sent as one keep-alive frame every MOTION_KEEPALIVE_MS.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <esp_http_server.h>
+
+#define STREAM_PORT             81
+#define STREAM_MAX_CLIENTS      4       // Concurrent /stream viewers
+#define STREAM_TASK_STACK       4096
+#define STREAM_HTTPD_STACK      8192    // /stats builds its JSON on the server task's stack
+#define STREAM_TASK_PRIORITY    5
+#define STREAM_SEND_TIMEOUT_S   5       // A client stalled this long is dropped
+#define STREAM_HELD_SOCKETS     1       // Request sockets handed to other tasks (GET /clip)
+
+typedef struct {
+    uint32_t ip;                // Peer IPv4, network order
+    uint32_t connectedMs;
+    uint32_t frames;
+    uint64_t bytes;
+    float fps;                  // Frames delivered over the last second
+    uint32_t gatedFrames;       // Withheld by the motion gate
+    uint32_t dropped;           // Captured while the client was busy (X-Seq gaps)
+    bool gated;                 // /stream?gate=0 turns the motion gate off
+} StreamClientInfo_t;
+
+// Starts the server; returns NULL on failure. Further handlers may be
+// registered on the returned handle.
+httpd_handle_t streamServerStart();
+
+// Copies up to `max` connected clients, returns how many
+uint8_t streamClients(StreamClientInfo_t* out, uint8_t max);
+
+// For a handler that passes its request's socket to a task of its own, as
+// /stream does: httpd leaves the fd open until streamSocketRelease(), which
+// closes the session. False if every hold is taken.
+bool streamSocketHold(int fd);
+void streamSocketRelease(int fd);
+
+// Blocking socket writes shared by the stream, clip and push senders,
+// looping on partial sends; false once the peer is gone or the socket's
+// send timeout expires. streamSendAllv advances the iovec array as it goes.
+struct iovec;
+bool streamSendAll(int fd, const void* data, size_t len);
+bool streamSendAllv(int fd, struct iovec* iov, int count);
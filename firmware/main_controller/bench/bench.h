@@ -0,0 +1,52 @@
+/**
+ * MOD-EVAC-MS - Microbenchmark Harness
+ * Times a kernel per iteration with the cycle counter and reports
+ * min / mean as a JSON line, matching the firmware's serial protocol:
+ *   {"type":"bench","name":"...","iters":N,"min":..,"mean":..,"unit":"cycles"}
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cycle_counter.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+static inline void benchPrint(const char* line) { Serial.println(line); }
+#else
+static inline void benchPrint(const char* line) { puts(line); }
+#endif
+
+typedef void (*BenchFn_t)(void* ctx);
+
+typedef struct {
+    uint32_t minCycles;
+    uint32_t meanCycles;
+} BenchResult_t;
+
+static inline BenchResult_t runBench(const char* name, BenchFn_t fn, void* ctx, uint32_t iters) {
+    // Warm caches and branch predictors before timing
+    for (uint32_t i = 0; i < 16; i++) fn(ctx);
+
+    uint32_t minCycles = UINT32_MAX;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        uint32_t start = cycleCount();
+        fn(ctx);
+        uint32_t elapsed = cycleCount() - start;
+        if (elapsed < minCycles) minCycles = elapsed;
+        total += elapsed;
+    }
+
+    BenchResult_t result = { minCycles, (uint32_t)(total / iters) };
+
+    char line[160];
+    snprintf(line, sizeof(line),
+             "{\"type\":\"bench\",\"name\":\"%s\",\"iters\":%lu,\"min\":%lu,\"mean\":%lu,\"unit\":\"%s\"}",
+             name, (unsigned long)iters, (unsigned long)result.minCycles,
+             (unsigned long)result.meanCycles, CYCLE_UNIT);
+    benchPrint(line);
+    return result;
+}
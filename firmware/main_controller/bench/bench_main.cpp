@@ -0,0 +1,280 @@
+/**
+ * MOD-EVAC-MS - Main Controller Microbenchmarks
+ * Hot paths of the controller firmware, timed in CPU cycles.
+ *
+ * The kernels are the same portable sources the firmware links, so the
+ * ESP32 build (env:bench) and the host build (env:native_bench) measure
+ * identical code:
+ *   pio run -e bench -t upload && pio device monitor
+ *   pio run -e native_bench && .pio/build/native_bench/program
+ *
+ * sensor_pipeline_float / sensor_pipeline_q15 time one acquisition step
+ * (burst decode to recorder sample and rule channels) on the old float
+ * path and on the fixed-point path sensorTask now runs.
+ *
+ * vib_fft_window is one full vibration analysis (128-point FFT, band
+ * reduction, crest factor), run every 64 samples (1.28 s) by sensorTask.
+ *
+ * On the board the suite also times the IMU bus read: the 14-byte burst
+ * at 400 kHz and 1 MHz against Adafruit getEvent at 100 kHz (needs the
+ * MPU6050 attached; divide cycles by 240 for microseconds).
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bench.h"
+#include "../src/command.h"
+#include "../src/fixed_point.h"
+#include "../src/led_patterns.h"
+#include "../src/mpu6050.h"
+#include "../src/rules_engine.h"
+#include "../src/sensor_convert.h"
+#include "../src/telemetry.h"
+#include "../src/vibration_fft.h"
+
+#define BENCH_ITERS 1000
+#define BENCH_I2C_ITERS 200
+
+#ifdef ARDUINO
+#include <Adafruit_MPU6050.h>
+#include <Adafruit_Sensor.h>
+#include "../src/hal/mpu6050_i2c.h"
+
+#define I2C_SDA 21
+#define I2C_SCL 22
+#endif
+
+// Results land here so the optimiser cannot drop the kernels
+static volatile uint32_t benchSink;
+
+// ============================================================================
+// KERNELS
+// ============================================================================
+
+static void benchTelemetryEncode(void* ctx) {
+    const TelemetrySnapshot_t* snap = (const TelemetrySnapshot_t*)ctx;
+    char line[TELEMETRY_MAX_LEN];
+    benchSink = encodeTelemetry(*snap, line, sizeof(line));
+}
+
+static void benchParseSetAlert(void*) {
+    Command_t cmd;
+    decodeCommand("{\"cmd\":\"set_alert\",\"alert\":3}", &cmd);
+    benchSink = cmd.type;
+}
+
+static void benchParseRulesSet(void*) {
+    Command_t cmd;
+    decodeCommand("{\"cmd\":\"rules_set\",\"rules\":[[0,0,70.0,5.0,500,3],"
+                  "[0,0,40.0,5.0,1000,1],[7,0,30.0,5.0,0,1]]}", &cmd);
+    benchSink = cmd.ruleCount;
+}
+
+static void benchZoneFill(void* ctx) {
+    Rgb_t* leds = (Rgb_t*)ctx;
+    fillAllZones(leds, Rgb_t{ 255, 150, 0 });
+    benchSink = leds[LED_COUNT - 1].r;
+}
+
+static void benchEvacuationFrame(void* ctx) {
+    static uint8_t phase = 0;
+    Rgb_t* leds = (Rgb_t*)ctx;
+    composeEvacuationFrame(leds, EXIT_ZONE, phase++);
+    benchSink = leds[0].g;
+}
+
+static void benchSensorConvert(void*) {
+    static int raw = 0;
+    const float accel[3] = { 0.12f, -0.31f, 9.81f };
+    const float gyro[3] = { 0.01f, 0.02f, -0.03f };
+    RecorderSample_t sample;
+    float channels[NUM_CHANNELS];
+
+    raw = (raw + 7) & 0xFFF;
+    float water = waterPercentFromRaw(raw);
+    packRecorderSample(&sample, 1234, raw, accel, gyro);
+    buildChannels(channels, water, accel, gyro);
+    benchSink = sample.water + (uint32_t)channels[CH_ACCEL_MAG];
+}
+
+static void benchImuDecode(void* ctx) {
+    static const uint8_t burst[MPU6050_BURST_BYTES] = {
+        0x00, 0x7B, 0xFE, 0x10, 0x0F, 0xF5, 0xEE, 0x50, 0x00, 0x21, 0xFF, 0xC4, 0x00, 0x07
+    };
+    const ImuScale_t* scale = (const ImuScale_t*)ctx;
+    ImuRaw_t raw;
+    float accel[3], gyro[3];
+    mpuDecodeBurst(burst, &raw);
+    imuToSi(raw, *scale, accel, gyro);
+    benchSink = (uint32_t)(accel[2] + gyro[0]);
+}
+
+// Same sample for both pipeline kernels
+static const uint8_t pipelineBurst[MPU6050_BURST_BYTES] = {
+    0x00, 0x7B, 0xF0, 0x10, 0x3C, 0xF5, 0xEE, 0x50, 0x00, 0x21, 0xFF, 0xC4, 0x00, 0x07
+};
+
+typedef struct {
+    ImuScale_t imu;
+    RecorderScaleQ_t recorder;
+} PipelineCtx_t;
+
+// Previous sensorTask step: SI floats throughout
+static void pipelineFloatStep(const PipelineCtx_t* p, float (*waterPercent)(int)) {
+    static int raw = 0;
+    ImuRaw_t imu;
+    float accel[3], gyro[3];
+    RecorderSample_t sample;
+    float channels[NUM_CHANNELS];
+
+    raw = (raw + 7) & 0xFFF;
+    mpuDecodeBurst(pipelineBurst, &imu);
+    imuToSi(imu, p->imu, accel, gyro);
+    float water = waterPercent(raw);
+    packRecorderSample(&sample, 1234, raw, accel, gyro);
+    buildChannels(channels, water, accel, gyro);
+    benchSink = sample.accel[2] + (uint32_t)channels[CH_ACCEL_MAG];
+}
+
+// Baseline: water % through the original double expression
+static void benchPipelineFloat(void* ctx) {
+    pipelineFloatStep((const PipelineCtx_t*)ctx, waterPercentFromRaw);
+}
+
+// Water % in single precision only
+static void benchPipelineF32(void* ctx) {
+    pipelineFloatStep((const PipelineCtx_t*)ctx, waterPercentFromRawF);
+}
+
+static void benchPipelineQ15(void* ctx) {
+    static int raw = 0;
+    const PipelineCtx_t* p = (const PipelineCtx_t*)ctx;
+    ImuRaw_t imu;
+    RecorderSample_t sample;
+    int32_t channels[NUM_CHANNELS];
+
+    raw = (raw + 7) & 0xFFF;
+    mpuDecodeBurst(pipelineBurst, &imu);
+    q15_t water = waterQ15FromRaw(raw);
+    packRecorderSampleQ(&sample, 1234, raw, imu, p->recorder);
+    buildChannelsQ(channels, water, imu, DERIVED_LEVELS_IDLE);
+    benchSink = sample.accel[2] + (uint32_t)channels[CH_ACCEL_MAG];
+}
+
+static void benchVibWindow(void* ctx) {
+    VibrationAnalyzer* analyzer = (VibrationAnalyzer*)ctx;
+    VibSpectrum_t spectrum;
+    analyzer->analyze(&spectrum);
+    benchSink = (uint32_t)spectrum.dominantHz;
+}
+
+#ifdef ARDUINO
+static void benchImuBurst(void*) {
+    uint8_t burst[MPU6050_BURST_BYTES];
+    benchSink = (mpuI2cReadBurst(burst) == I2C_OK) ? burst[5] : 0;
+}
+
+static void benchImuAdafruit(void* ctx) {
+    Adafruit_MPU6050* mpu = (Adafruit_MPU6050*)ctx;
+    sensors_event_t a, g, temp;
+    mpu->getEvent(&a, &g, &temp);
+    benchSink = (uint32_t)a.acceleration.z;
+}
+
+// Bus-bound kernels: only meaningful with the sensor on the bus
+static void runImuBusSuite() {
+    if (mpuI2cBegin(I2C_SDA, I2C_SCL, 400000, MPU_ACCEL_8G, MPU_GYRO_500DPS, MPU_DLPF_21HZ) != I2C_OK) {
+        benchPrint("{\"event\":\"bench\",\"status\":\"skip\",\"name\":\"imu_i2c\",\"reason\":\"no_mpu6050\"}");
+        return;
+    }
+    runBench("imu_burst_400k", benchImuBurst, NULL, BENCH_I2C_ITERS);
+    mpuI2cSetClock(1000000);
+    runBench("imu_burst_1m", benchImuBurst, NULL, BENCH_I2C_ITERS);
+
+    // Previous driver: Adafruit defaults to 100 kHz and scales every field
+    static Adafruit_MPU6050 mpu;
+    mpuI2cSetClock(100000);
+    if (mpu.begin()) {
+        mpu.setAccelerometerRange(MPU6050_RANGE_8_G);
+        mpu.setGyroRange(MPU6050_RANGE_500_DEG);
+        runBench("imu_adafruit_100k", benchImuAdafruit, &mpu, BENCH_I2C_ITERS);
+    }
+}
+#endif
+
+static void benchRulesEvaluate(void* ctx) {
+    static uint32_t t = 0;
+    RulesEngine* engine = (RulesEngine*)ctx;
+    const int32_t channels[NUM_CHANNELS] = { 13762, 42, 84, 4096, 38, 75, 113, 113, 4097, 0, 0, 10, 0, 86400 };
+    benchSink = engine->evaluate(channels, t += 20);
+}
+
+// ============================================================================
+// SUITE
+// ============================================================================
+
+static void runSuite() {
+    static Rgb_t leds[LED_COUNT];
+    TelemetrySnapshot_t snap = { 42.5f, { 0.01f, -0.02f, 0.03f }, { 0.12f, -0.31f, 9.81f }, 0, true, 0, 123456 };
+
+    RulesEngine engine;
+    const HazardRule_t rules[] = {
+        { CH_WATER,   RULE_ABOVE, 3, 0, 70.0f, 5.0f, 500  },
+        { CH_WATER,   RULE_ABOVE, 1, 0, 40.0f, 5.0f, 1000 },
+        { CH_GYRO_XY, RULE_ABOVE, 1, 0, 30.0f, 5.0f, 0    },
+    };
+    ImuScale_t imuScale = mpuScale(MPU_ACCEL_8G, MPU_GYRO_500DPS);
+    float scales[NUM_CHANNELS];
+    sensorChannelScales(imuScale, scales);
+    engine.setScales(scales);
+    engine.load(rules, sizeof(rules) / sizeof(rules[0]));
+    PipelineCtx_t pipeline = { imuScale, recorderScaleQ(imuScale) };
+
+    // 3 Hz horizontal shaking on a level board, window filled
+    static VibrationAnalyzer analyzer;
+    analyzer.begin(50.0f, imuScale.accel);
+    for (uint16_t i = 0; i < VIB_FFT_N; i++) {
+        float accel[3] = { 0.5f * sinf(6.2831853f * 3.0f * i / 50.0f), 0.0f, 9.81f };
+        float gyro[3] = { 0.0f, 0.0f, 0.0f };
+        ImuRaw_t shake;
+        imuFromSi(accel, gyro, imuScale, &shake);
+        analyzer.push(shake, i * 20);
+    }
+
+    benchPrint("{\"event\":\"bench\",\"status\":\"start\"}");
+    runBench("telemetry_encode", benchTelemetryEncode, &snap, BENCH_ITERS);
+    runBench("parse_set_alert", benchParseSetAlert, NULL, BENCH_ITERS);
+    runBench("parse_rules_set", benchParseRulesSet, NULL, BENCH_ITERS);
+    runBench("zone_fill_all", benchZoneFill, leds, BENCH_ITERS);
+    runBench("evacuation_frame", benchEvacuationFrame, leds, BENCH_ITERS);
+    runBench("sensor_convert", benchSensorConvert, NULL, BENCH_ITERS);
+    runBench("rules_evaluate", benchRulesEvaluate, &engine, BENCH_ITERS);
+    runBench("imu_decode_scale", benchImuDecode, &imuScale, BENCH_ITERS);
+    runBench("sensor_pipeline_float", benchPipelineFloat, &pipeline, BENCH_ITERS);
+    runBench("sensor_pipeline_f32", benchPipelineF32, &pipeline, BENCH_ITERS);
+    runBench("sensor_pipeline_q15", benchPipelineQ15, &pipeline, BENCH_ITERS);
+    runBench("vib_fft_window", benchVibWindow, &analyzer, BENCH_ITERS);
+#ifdef ARDUINO
+    runImuBusSuite();
+#endif
+    benchPrint("{\"event\":\"bench\",\"status\":\"complete\"}");
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+    runSuite();
+}
+
+void loop() {
+    vTaskDelay(portMAX_DELAY);
+}
+#else
+int main() {
+    runSuite();
+    return 0;
+}
+#endif
@@ -0,0 +1,32 @@
+/**
+ * MOD-EVAC-MS - Cycle Counter
+ * CPU cycle timestamps for the benchmark suite.
+ *
+ * ESP32: Xtensa CCOUNT register (xthal_get_ccount), true core cycles.
+ * Native x86: TSC ticks. Other hosts: nanoseconds from steady_clock.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP_PLATFORM)
+#include <xtensa/hal.h>
+#define CYCLE_UNIT "cycles"
+static inline uint32_t cycleCount() {
+    return xthal_get_ccount();
+}
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_UNIT "tsc"
+static inline uint32_t cycleCount() {
+    return (uint32_t)__rdtsc();
+}
+#else
+#include <chrono>
+#define CYCLE_UNIT "ns"
+static inline uint32_t cycleCount() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
@@ -0,0 +1,521 @@
+/**
+ * MOD-EVAC-MS - Controller Emulator (backend load test)
+ * Spawns N virtual main controllers, each running the unmodified app.cpp
+ * on hal_posix.cpp in its own process, and exposes each one as a PTY that
+ * the backend opens like the real USB serial port:
+ *
+ *   pio run -e emulator
+ *   .pio/build/emulator/program -n 8 --rate 20 --profile flood --link-dir /tmp/modevac
+ *   python backend/sensor_worker.py --port /tmp/modevac/ctrl0    (one per controller)
+ *
+ * The parent process sits between each PTY and its controller and:
+ * - paces device output at --baud (0 = unlimited), dropping whole lines
+ *   that would overflow the UART FIFO when the backend falls behind
+ * - counts lines / bytes / commands per controller
+ * - measures command round-trip: from the first telemetry line whose water
+ *   level crosses --rtt-threshold upward to the backend's set_alert >= DANGER
+ *
+ * Waveforms come from --replay (CSV or flight-recorder .bin, see
+ * sim/replay_file.h) or a synthetic --profile, looped, with each controller
+ * starting at a different offset. --speed runs the controllers' clock
+ * faster, which multiplies every device-side rate including telemetry.
+ *
+ * A JSON report is printed (or written to --report) on exit or Ctrl-C.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../sim/replay_file.h"
+#include "../src/app.h"
+#include "../src/hal/hal_posix.h"
+#include "../src/sensor_convert.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+#define EMU_MAX_CONTROLLERS     64
+#define EMU_TX_BUFFER_BYTES     4096    // Device-side FIFO before output is dropped
+#define EMU_PROFILE_MS          120000  // Length of the synthetic waveforms
+#define EMU_ALERT_DANGER        3       // AlertState_t ALERT_DANGER
+
+typedef struct {
+    int count;
+    uint32_t telemetryHz;
+    uint32_t baud;
+    double speed;
+    double durationS;
+    const char* replayPath;
+    const char* profile;
+    const char* linkDir;
+    const char* reportPath;
+    float rttThreshold;
+    uint32_t rttTimeoutMs;
+} EmuOptions_t;
+
+typedef struct {
+    uint64_t linesOut, bytesOut, telemetryOut;
+    uint64_t linesIn, bytesIn, commandsIn;
+    uint64_t droppedLines;
+    uint64_t rttUnanswered;
+    std::vector<uint32_t> rttUs;
+} EmuStats_t;
+
+typedef struct {
+    pid_t pid;
+    int masterFd;
+    int slaveFd;                // Held open so the master never sees EIO
+    int toChild;                // Backend -> controller
+    int fromChild;              // Controller -> backend
+    char slavePath[64];
+
+    std::string devLine;        // Partial line from the controller
+    std::string hostLine;       // Partial line from the backend
+    std::string txQueue;        // Paced output waiting for the PTY
+    double txCredit;
+
+    float lastWater;
+    bool rttPending;
+    uint64_t rttStartUs;
+
+    EmuStats_t stats;
+} EmuController_t;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) { stopRequested = 1; }
+
+static uint64_t nowUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// ============================================================================
+// SYNTHETIC WAVEFORMS (one sample per sensor period, looped)
+// ============================================================================
+static int rawFromPercent(float pct) {
+    return (int)(pct / 100.0f * WATER_ADC_MAX + 0.5f);
+}
+
+static bool buildProfile(const char* name, std::vector<ReplaySample_t>& out) {
+    bool flood = !strcmp(name, "flood");
+    bool quake = !strcmp(name, "quake");
+    if (!flood && !quake && strcmp(name, "quiet")) return false;
+
+    uint32_t seed = 12345;
+    for (uint32_t t = 0; t < EMU_PROFILE_MS; t += 20) {
+        // Small LCG noise so consecutive samples differ
+        seed = seed * 1103515245u + 12345u;
+        float noise = ((seed >> 16) & 0x7FFF) / 32767.0f - 0.5f;
+
+        ReplaySample_t s = {};
+        s.tMs = t;
+
+        // flood: 10% -> 95% over the first half, back down over the second
+        float water = 10.0f;
+        if (flood) {
+            float half = EMU_PROFILE_MS / 2.0f;
+            water = (t < half) ? 10.0f + 85.0f * (t / half) : 95.0f - 85.0f * ((t - half) / half);
+        }
+        s.rawWater = rawFromPercent(water + noise);
+
+        s.accel[2] = 9.81f + 0.05f * noise;
+        s.gyro[0] = 0.01f * noise;
+        s.gyro[1] = -0.01f * noise;
+
+        // quake: 5 s, 3 Hz shaking burst every 30 s
+        if (quake && (t % 30000) < 5000) {
+            float w = sinf(2.0f * (float)M_PI * 3.0f * t / 1000.0f);
+            s.accel[0] = 2.0f * w;
+            s.accel[1] = 1.5f * w;
+            s.gyro[0] = 0.8f * w;
+            s.gyro[1] = 0.6f * w;
+        }
+        out.push_back(s);
+    }
+    return true;
+}
+
+// ============================================================================
+// CONTROLLER PROCESSES
+// ============================================================================
+static bool openPty(EmuController_t& c) {
+    c.masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (c.masterFd < 0 || grantpt(c.masterFd) < 0 || unlockpt(c.masterFd) < 0) return false;
+
+    const char* name = ptsname(c.masterFd);
+    if (!name) return false;
+    snprintf(c.slavePath, sizeof(c.slavePath), "%s", name);
+
+    c.slaveFd = open(c.slavePath, O_RDWR | O_NOCTTY);
+    if (c.slaveFd < 0) return false;
+
+    // Raw 8N1, no echo or CR/LF translation - same as the CP2102 on the board
+    struct termios tio;
+    tcgetattr(c.slaveFd, &tio);
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B115200);
+    tcsetattr(c.slaveFd, TCSANOW, &tio);
+
+    fcntl(c.masterFd, F_SETFL, fcntl(c.masterFd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+// Forks one controller. The child never returns.
+static bool spawnController(EmuController_t* ctrls, int index, const EmuOptions_t& opt,
+                            const std::vector<ReplaySample_t>& samples) {
+    EmuController_t& c = ctrls[index];
+    int down[2], up[2];
+    if (pipe(down) < 0 || pipe(up) < 0) return false;
+
+    pid_t pid = fork();
+    if (pid < 0) return false;
+
+    if (pid == 0) {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        signal(SIGINT, SIG_IGN);
+        for (int i = 0; i < index; i++) {
+            close(ctrls[i].masterFd);
+            close(ctrls[i].slaveFd);
+            close(ctrls[i].toChild);
+            close(ctrls[i].fromChild);
+        }
+        close(c.masterFd);
+        close(c.slaveFd);
+        close(down[1]);
+        close(up[0]);
+
+        // Spread controllers across the recording so they don't move in lockstep
+        uint32_t span = samples.empty() ? 0 : samples.back().tMs - samples.front().tMs;
+
+        HalPosixConfig_t config = {};
+        config.speed = opt.speed;
+        config.hostInFd = down[0];
+        config.hostOutFd = up[1];
+        config.gsmOutFd = -1;
+        config.samples = samples.empty() ? NULL : samples.data();
+        config.sampleCount = samples.size();
+        config.loop = true;
+        config.replayOffsetMs = (uint32_t)((uint64_t)span * index / opt.count);
+        halPosixConfigure(config);
+
+        appSetTelemetryPeriod(1000 / opt.telemetryHz);
+        appSetup();
+        for (;;) pause();
+    }
+
+    close(down[0]);
+    close(up[1]);
+    c.pid = pid;
+    c.toChild = down[1];
+    c.fromChild = up[0];
+    fcntl(c.fromChild, F_SETFL, fcntl(c.fromChild, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+// ============================================================================
+// LINE INSPECTION
+// ============================================================================
+static bool jsonNumber(const std::string& line, const char* key, float* out) {
+    size_t p = line.find(key);
+    if (p == std::string::npos) return false;
+    *out = strtof(line.c_str() + p + strlen(key), NULL);
+    return true;
+}
+
+// Complete line from the controller, on its way to the backend
+static void onDeviceLine(EmuController_t& c, const std::string& line, const EmuOptions_t& opt) {
+    c.stats.linesOut++;
+
+    // Whole lines only, so an overflow never hands the backend a spliced record
+    if (c.txQueue.size() + line.size() + 1 > EMU_TX_BUFFER_BYTES) {
+        c.stats.droppedLines++;
+        return;
+    }
+    c.txQueue += line;
+    c.txQueue += '\n';
+
+    if (line.find("\"type\":\"telemetry\"") == std::string::npos) return;
+    c.stats.telemetryOut++;
+
+    float water;
+    if (!jsonNumber(line, "\"water\":", &water)) return;
+    if (water >= opt.rttThreshold && c.lastWater < opt.rttThreshold && !c.rttPending) {
+        c.rttPending = true;
+        c.rttStartUs = nowUs();
+    }
+    c.lastWater = water;
+}
+
+// Complete line from the backend, on its way to the controller
+static void onHostLine(EmuController_t& c, const std::string& line) {
+    c.stats.linesIn++;
+    if (line.find("\"cmd\"") != std::string::npos) c.stats.commandsIn++;
+    if (!c.rttPending || line.find("\"set_alert\"") == std::string::npos) return;
+
+    float alert;
+    if (jsonNumber(line, "\"alert\":", &alert) && alert >= EMU_ALERT_DANGER) {
+        c.stats.rttUs.push_back((uint32_t)(nowUs() - c.rttStartUs));
+        c.rttPending = false;
+    }
+}
+
+// Splits `data` into lines, calling fn on each complete one
+template <typename Fn>
+static void feedLines(std::string& partial, const char* data, size_t len, Fn fn) {
+    for (size_t i = 0; i < len; i++) {
+        char ch = data[i];
+        if (ch == '\n' || ch == '\r') {
+            if (!partial.empty()) fn(partial);
+            partial.clear();
+        } else if (partial.size() < 2048) {
+            partial += ch;
+        }
+    }
+}
+
+// ============================================================================
+// PUMP
+// ============================================================================
+static void pumpDevice(EmuController_t& c, const EmuOptions_t& opt) {
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(c.fromChild, buf, sizeof(buf))) > 0) {
+        feedLines(c.devLine, buf, (size_t)n, [&](const std::string& l) { onDeviceLine(c, l, opt); });
+        c.stats.bytesOut += (uint64_t)n;
+    }
+}
+
+static void pumpHost(EmuController_t& c) {
+    char buf[1024];
+    ssize_t n;
+    while ((n = read(c.masterFd, buf, sizeof(buf))) > 0) {
+        feedLines(c.hostLine, buf, (size_t)n, [&](const std::string& l) { onHostLine(c, l); });
+        c.stats.bytesIn += (uint64_t)n;
+
+        // Pipe to the controller; it drains continuously in serialTask
+        ssize_t off = 0;
+        while (off < n) {
+            ssize_t w = write(c.toChild, buf + off, (size_t)(n - off));
+            if (w < 0 && errno != EINTR) break;
+            if (w > 0) off += w;
+        }
+    }
+}
+
+static void flushTx(EmuController_t& c, const EmuOptions_t& opt, double elapsedS) {
+    size_t allowed = c.txQueue.size();
+    if (opt.baud) {
+        // 10 bits per byte on the wire (8N1); credit capped at one FIFO
+        c.txCredit = std::min(c.txCredit + elapsedS * opt.baud / 10.0, (double)EMU_TX_BUFFER_BYTES);
+        allowed = std::min(allowed, (size_t)c.txCredit);
+    }
+    if (allowed == 0) return;
+
+    ssize_t w = write(c.masterFd, c.txQueue.data(), allowed);
+    if (w > 0) {
+        c.txQueue.erase(0, (size_t)w);
+        if (opt.baud) c.txCredit -= w;
+    }
+}
+
+static void expireRtt(EmuController_t& c, const EmuOptions_t& opt) {
+    if (c.rttPending && nowUs() - c.rttStartUs > (uint64_t)opt.rttTimeoutMs * 1000) {
+        c.rttPending = false;
+        c.stats.rttUnanswered++;
+    }
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+static uint32_t percentile(std::vector<uint32_t> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+static void printRttFields(FILE* f, const std::vector<uint32_t>& v) {
+    fprintf(f, "\"rtt_count\":%zu,\"rtt_p50_ms\":%.2f,\"rtt_p95_ms\":%.2f,\"rtt_max_ms\":%.2f",
+            v.size(), percentile(v, 0.50) / 1000.0, percentile(v, 0.95) / 1000.0,
+            v.empty() ? 0.0 : *std::max_element(v.begin(), v.end()) / 1000.0);
+}
+
+static void writeReport(FILE* f, const EmuController_t* ctrls, const EmuOptions_t& opt, double wallS) {
+    EmuStats_t total = {};
+    fprintf(f, "{\"type\":\"emulator_report\",\"controllers\":%d,\"telemetry_hz\":%u,\"baud\":%u,"
+               "\"speed\":%.2f,\"wall_s\":%.2f,\"per_controller\":[",
+            opt.count, opt.telemetryHz, opt.baud, opt.speed, wallS);
+
+    for (int i = 0; i < opt.count; i++) {
+        const EmuStats_t& s = ctrls[i].stats;
+        fprintf(f, "%s{\"port\":\"%s\",\"lines_out\":%llu,\"telemetry_out\":%llu,\"bytes_out\":%llu,"
+                   "\"dropped_lines\":%llu,\"commands_in\":%llu,\"bytes_in\":%llu,\"rtt_unanswered\":%llu,",
+                i ? "," : "", ctrls[i].slavePath,
+                (unsigned long long)s.linesOut, (unsigned long long)s.telemetryOut,
+                (unsigned long long)s.bytesOut, (unsigned long long)s.droppedLines,
+                (unsigned long long)s.commandsIn, (unsigned long long)s.bytesIn,
+                (unsigned long long)s.rttUnanswered);
+        printRttFields(f, s.rttUs);
+        fprintf(f, "}");
+
+        total.linesOut += s.linesOut;
+        total.telemetryOut += s.telemetryOut;
+        total.bytesOut += s.bytesOut;
+        total.droppedLines += s.droppedLines;
+        total.commandsIn += s.commandsIn;
+        total.rttUnanswered += s.rttUnanswered;
+        total.rttUs.insert(total.rttUs.end(), s.rttUs.begin(), s.rttUs.end());
+    }
+
+    double telemetryRate = wallS > 0 ? total.telemetryOut / wallS : 0;
+    fprintf(f, "],\"total\":{\"lines_out\":%llu,\"telemetry_per_s\":%.1f,\"bytes_out\":%llu,"
+               "\"dropped_lines\":%llu,\"commands_in\":%llu,\"rtt_unanswered\":%llu,",
+            (unsigned long long)total.linesOut, telemetryRate, (unsigned long long)total.bytesOut,
+            (unsigned long long)total.droppedLines, (unsigned long long)total.commandsIn,
+            (unsigned long long)total.rttUnanswered);
+    printRttFields(f, total.rttUs);
+    fprintf(f, "}}\n");
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [-n N] [--rate HZ] [--baud B] [--speed X] [--duration S]\n"
+            "          [--replay FILE | --profile quiet|flood|quake] [--link-dir DIR]\n"
+            "          [--report FILE] [--rtt-threshold PCT] [--rtt-timeout-ms MS]\n",
+            argv0);
+}
+
+int main(int argc, char** argv) {
+    EmuOptions_t opt = { 4, 10, 115200, 1.0, 0, NULL, "quiet", NULL, NULL, 70.0f, 5000 };
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((!strcmp(a, "-n") || !strcmp(a, "--count")) && hasValue) opt.count = atoi(argv[++i]);
+        else if (!strcmp(a, "--rate") && hasValue) opt.telemetryHz = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(a, "--baud") && hasValue) opt.baud = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(a, "--speed") && hasValue) opt.speed = atof(argv[++i]);
+        else if (!strcmp(a, "--duration") && hasValue) opt.durationS = atof(argv[++i]);
+        else if (!strcmp(a, "--replay") && hasValue) opt.replayPath = argv[++i];
+        else if (!strcmp(a, "--profile") && hasValue) opt.profile = argv[++i];
+        else if (!strcmp(a, "--link-dir") && hasValue) opt.linkDir = argv[++i];
+        else if (!strcmp(a, "--report") && hasValue) opt.reportPath = argv[++i];
+        else if (!strcmp(a, "--rtt-threshold") && hasValue) opt.rttThreshold = (float)atof(argv[++i]);
+        else if (!strcmp(a, "--rtt-timeout-ms") && hasValue) opt.rttTimeoutMs = (uint32_t)atoi(argv[++i]);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opt.count < 1 || opt.count > EMU_MAX_CONTROLLERS || opt.telemetryHz < 1 || opt.telemetryHz > 100) {
+        fprintf(stderr, "emulator: need 1..%d controllers and 1..100 Hz telemetry\n", EMU_MAX_CONTROLLERS);
+        return 2;
+    }
+    if (opt.speed <= 0) opt.speed = 1.0;
+
+    std::vector<ReplaySample_t> samples;
+    if (opt.replayPath) {
+        if (!loadReplayFile(opt.replayPath, samples) || samples.empty()) {
+            fprintf(stderr, "emulator: no samples in %s\n", opt.replayPath);
+            return 1;
+        }
+    } else if (!buildProfile(opt.profile, samples)) {
+        fprintf(stderr, "emulator: unknown profile %s\n", opt.profile);
+        return 2;
+    }
+
+    if (opt.linkDir) mkdir(opt.linkDir, 0755);
+
+    static EmuController_t ctrls[EMU_MAX_CONTROLLERS];
+    for (int i = 0; i < opt.count; i++) {
+        EmuController_t& c = ctrls[i];
+        c.lastWater = 0;
+        if (!openPty(c) || !spawnController(ctrls, i, opt, samples)) {
+            perror("emulator: controller setup");
+            return 1;
+        }
+        if (opt.linkDir) {
+            char link[256];
+            snprintf(link, sizeof(link), "%s/ctrl%d", opt.linkDir, i);
+            unlink(link);
+            if (symlink(c.slavePath, link) < 0) perror(link);
+            fprintf(stderr, "ctrl%d: %s -> %s\n", i, link, c.slavePath);
+        } else {
+            fprintf(stderr, "ctrl%d: %s\n", i, c.slavePath);
+        }
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    struct pollfd fds[EMU_MAX_CONTROLLERS * 2];
+    uint64_t startUs = nowUs();
+    uint64_t lastUs = startUs;
+
+    while (!stopRequested) {
+        if (opt.durationS > 0 && (nowUs() - startUs) >= (uint64_t)(opt.durationS * 1e6)) break;
+
+        bool backlog = false;
+        for (int i = 0; i < opt.count; i++) {
+            fds[2 * i] = { ctrls[i].fromChild, POLLIN, 0 };
+            fds[2 * i + 1] = { ctrls[i].masterFd, POLLIN, 0 };
+            if (!ctrls[i].txQueue.empty()) backlog = true;
+        }
+        // Paced output needs a short tick; otherwise wake on traffic only
+        poll(fds, (nfds_t)(opt.count * 2), backlog ? 2 : 50);
+
+        uint64_t now = nowUs();
+        double elapsedS = (now - lastUs) / 1e6;
+        lastUs = now;
+
+        for (int i = 0; i < opt.count; i++) {
+            pumpDevice(ctrls[i], opt);
+            pumpHost(ctrls[i]);
+            flushTx(ctrls[i], opt, elapsedS);
+            expireRtt(ctrls[i], opt);
+        }
+    }
+
+    double wallS = (nowUs() - startUs) / 1e6;
+    for (int i = 0; i < opt.count; i++) {
+        kill(ctrls[i].pid, SIGKILL);
+        waitpid(ctrls[i].pid, NULL, 0);
+        if (opt.linkDir) {
+            char link[256];
+            snprintf(link, sizeof(link), "%s/ctrl%d", opt.linkDir, i);
+            unlink(link);
+        }
+    }
+
+    FILE* report = stderr;
+    if (opt.reportPath && !(report = fopen(opt.reportPath, "w"))) {
+        perror(opt.reportPath);
+        report = stderr;
+    }
+    writeReport(report, ctrls, opt, wallS);
+    if (report != stderr) fclose(report);
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * MOD-EVAC-MS - Offline Replay
+ * Feeds a recording through the sensor task's per-sample step
+ * (sensor_pipeline.h: quantised to IMU counts, analyzers, channel vector,
+ * rules and escalation, the same code as on the device) in a single
+ * thread, one sample at a time, with the recording's own timestamps. The
+ * host link is taken to be up, so the failsafe never engages. No
+ * scheduler and no wall clock, so the same file and rules always produce
+ * the same events, as fast as the CPU allows.
+ */
+
+#include "offline_replay.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/channel_stats.h"
+#include "../src/command.h"
+#include "../src/sensor_pipeline.h"
+
+// AlertState_t (app.cpp)
+static const uint8_t LEVEL_DANGER = 3;
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Same JSON array as the rules_set command: [[ch,op,thr,hyst,hold_ms,alert],...]
+static bool loadRules(RulesEngine& rules, const char* rulesJson) {
+    if (!rulesJson) return rules.load(DEFAULT_HAZARD_RULES, DEFAULT_HAZARD_RULE_COUNT);
+
+    static char line[2048];
+    snprintf(line, sizeof(line), "{\"cmd\":\"rules_set\",\"rules\":%s}", rulesJson);
+    static Command_t cmd;
+    if (!decodeCommand(line, &cmd) || cmd.type != CMD_RULES_SET || !cmd.rulesValid) return false;
+    return rules.load(cmd.rules, cmd.ruleCount);
+}
+
+int runOfflineReplay(const std::vector<ReplaySample_t>& samples, const char* rulesJson) {
+    // Same range as the controller and the posix HAL replay
+    const ImuScale_t imuScale = mpuScale(MPU_ACCEL_8G, MPU_GYRO_500DPS);
+    float scales[NUM_CHANNELS];
+    sensorChannelScales(imuScale, scales);
+
+    RulesEngine rules;
+    rules.setScales(scales);
+
+    // Recordings are replayed at their own rate, assumed to be the 50 Hz
+    // sensor period
+    SensorPipeline pipeline;
+    pipeline.begin(50.0f, imuScale);
+    if (!loadRules(rules, rulesJson)) {
+        fprintf(stderr, "replay: invalid rules\n");
+        return 2;
+    }
+
+    float dangerPercent;
+    if (rules.highestThreshold(CH_WATER, RULE_ABOVE, &dangerPercent)) {
+        pipeline.setWaterThreshold((int32_t)(dangerPercent * (Q15_ONE / 100.0f) + 0.5f));
+    }
+
+    LinkWatchdog link;
+    ChannelStats stats;
+    ChannelWindow_t window;
+    if (!samples.empty()) {
+        link.begin(LINK_TIMEOUT_DEFAULT_MS, samples.front().tMs);
+        stats.begin(STATS_WINDOW_DEFAULT_MS, samples.front().tMs);
+    }
+
+    uint32_t fired = 0;
+    uint8_t alert = 0;
+    double cpuStart = cpuSeconds();
+
+    for (const ReplaySample_t& s : samples) {
+        ImuRaw_t imu;
+        imuFromSi(s.accel, s.gyro, imuScale, &imu);
+        q15_t water = waterQ15FromRaw(s.rawWater);
+        int32_t channels[NUM_CHANNELS];
+        PipelineEvents_t ev = pipeline.process(water, imu, s.tMs, channels);
+
+        if (ev.intensityChanged) {
+            const GroundMotion_t& gm = pipeline.ground();
+            printf("{\"event\":\"intensity\",\"level\":%u,\"mmi\":%.1f,\"pga\":%.2f,\"pgv\":%.3f,\"ts\":%lu}\n",
+                   gm.level, gm.mmi, gm.pga, gm.pgv, (unsigned long)s.tMs);
+        }
+        if (ev.waterRisingChanged) {
+            const WaterTrend_t& wt = pipeline.water();
+            printf("{\"type\":\"water_trend\",\"level\":%.1f,\"rate\":%.2f,\"eta_s\":%ld,\"rising\":%s,\"ts\":%lu}\n",
+                   wt.level, wt.ratePctMin, (long)wt.etaS, wt.rising ? "true" : "false", (unsigned long)s.tMs);
+        }
+
+        // Windowed aggregates, as the "agg" record reports them
+        stats.add(channels, s.tMs);
+        if (stats.take(&window) && window.count > 0) {
+            printf("{\"type\":\"agg\",\"ts\":%lu,\"window_ms\":%lu,\"n\":%lu,\"ch\":{",
+                   (unsigned long)window.endMs, (unsigned long)(window.endMs - window.startMs),
+                   (unsigned long)window.count);
+            bool first = true;
+            for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+                if (window.n[c] == 0) continue;
+                printf("%s\"%s\":{\"min\":%g,\"max\":%g,\"mean\":%g,\"rms\":%g}", first ? "" : ",",
+                       SENSOR_CHANNEL_NAMES[c], window.min[c] * scales[c], window.max[c] * scales[c],
+                       channelMean(window, c) * scales[c], channelRms(window, c) * scales[c]);
+            }
+            printf("}}\n");
+        }
+
+        // Host present throughout: the watchdog is fed every sample
+        link.feed(s.tMs);
+        uint8_t next = escalateAlert(rules, link, channels, s.tMs, alert);
+
+        uint32_t firedMask = rules.takeFired();
+        uint32_t clearedMask = rules.takeCleared();
+        for (uint8_t i = 0; i < rules.count(); i++) {
+            const HazardRule_t& r = rules.rule(i);
+            if (firedMask & (1UL << i)) {
+                printf("{\"event\":\"rule_fired\",\"rule\":%u,\"channel\":%u,\"alert\":%u,\"value\":%.3f,\"ts\":%lu}\n",
+                       i, r.channel, r.alert, rules.firedValue(i), (unsigned long)s.tMs);
+                fired++;
+            }
+            if (clearedMask & (1UL << i)) {
+                printf("{\"event\":\"rule_cleared\",\"rule\":%u,\"ts\":%lu}\n", i, (unsigned long)s.tMs);
+            }
+        }
+
+        // Alerts only escalate, as on the device; crossing into DANGER is
+        // where the flight recorder would freeze its window
+        if (next > alert) {
+            printf("{\"event\":\"alert\",\"level\":%u,\"prev\":%u,\"rec_trigger\":%s,\"ts\":%lu}\n",
+                   next, alert, (next >= LEVEL_DANGER && alert < LEVEL_DANGER) ? "true" : "false", (unsigned long)s.tMs);
+            alert = next;
+        }
+    }
+
+    double cpu = cpuSeconds() - cpuStart;
+    uint32_t spanMs = samples.empty() ? 0 : samples.back().tMs - samples.front().tMs;
+    printf("{\"type\":\"replay_summary\",\"samples\":%zu,\"span_ms\":%lu,\"rules\":%u,\"fired\":%lu,"
+           "\"max_alert\":%u,\"cpu_ms\":%.3f,\"realtime_x\":%.0f}\n",
+           samples.size(), (unsigned long)spanMs, rules.count(), (unsigned long)fired, alert,
+           cpu * 1000.0, cpu > 0 ? spanMs / (cpu * 1000.0) : 0.0);
+    return 0;
+}
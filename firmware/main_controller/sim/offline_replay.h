@@ -0,0 +1,16 @@
+/**
+ * MOD-EVAC-MS - Offline Replay
+ * Deterministic, faster-than-real-time run of the detection pipeline over
+ * a recording, for threshold tuning and algorithm benchmarks.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "../src/hal/hal_posix.h"
+
+// Prints intensity, water_trend, agg, rule_fired / rule_cleared and alert
+// lines stamped with sample time, then a replay_summary record. rulesJson uses the rules_set array format; NULL
+// selects the firmware defaults. Returns a process exit code.
+int runOfflineReplay(const std::vector<ReplaySample_t>& samples, const char* rulesJson);
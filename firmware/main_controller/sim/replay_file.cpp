@@ -0,0 +1,104 @@
+/**
+ * MOD-EVAC-MS - Replay File Loading
+ */
+
+#include "replay_file.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/capture_format.h"
+#include "../src/flight_recorder.h"
+
+// ============================================================================
+// FORMATS
+// ============================================================================
+static bool endsWith(const char* s, const char* suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static bool loadCsv(const char* path, std::vector<ReplaySample_t>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        ReplaySample_t s;
+        unsigned long t;
+        int n = sscanf(line, "%lu,%d,%f,%f,%f,%f,%f,%f", &t, &s.rawWater,
+                       &s.accel[0], &s.accel[1], &s.accel[2],
+                       &s.gyro[0], &s.gyro[1], &s.gyro[2]);
+        if (n != 8) continue;   // Header or comment line
+        s.tMs = (uint32_t)t;
+        out.push_back(s);
+    }
+    fclose(f);
+    return true;
+}
+
+// Flight-recorder dump: RECORDER_SAMPLE_BYTES little-endian records with
+// accel in cm/s^2 and gyro in mrad/s (see flight_recorder.h)
+static bool loadRecorderDump(const char* path, std::vector<ReplaySample_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    uint8_t rec[RECORDER_SAMPLE_BYTES];
+    while (fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+        ReplaySample_t s;
+        s.tMs = (uint32_t)rec[0] | ((uint32_t)rec[1] << 8) | ((uint32_t)rec[2] << 16) | ((uint32_t)rec[3] << 24);
+        for (int i = 0; i < 3; i++) {
+            int16_t a = (int16_t)(rec[4 + 2 * i] | (rec[5 + 2 * i] << 8));
+            int16_t g = (int16_t)(rec[10 + 2 * i] | (rec[11 + 2 * i] << 8));
+            s.accel[i] = a * RECORDER_ACCEL_SCALE;
+            s.gyro[i] = g * RECORDER_GYRO_SCALE;
+        }
+        s.rawWater = rec[16] | (rec[17] << 8);
+        out.push_back(s);
+    }
+    fclose(f);
+    return true;
+}
+
+// Raw stream capture (capture_format.h); scales come from its header. At
+// the replay HAL's range the counts survive the round trip through SI
+// exactly (imuFromSi rounds).
+static bool loadCapture(const char* path, std::vector<ReplaySample_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    CaptureReader reader;
+    if (!reader.begin(data.data(), data.size())) {
+        fprintf(stderr, "%s: not a capture file\n", path);
+        return false;
+    }
+
+    const CaptureHeader_t& h = reader.header();
+    CaptureSample_t r;
+    while (reader.next(&r)) {
+        ReplaySample_t s;
+        s.tMs = r.tMs;
+        s.rawWater = r.water;
+        for (int i = 0; i < 3; i++) {
+            s.accel[i] = r.accel[i] * h.accelScale;
+            s.gyro[i] = r.gyro[i] * h.gyroScale;
+        }
+        out.push_back(s);
+    }
+    if (reader.badBlocks() || reader.missingBlocks()) {
+        fprintf(stderr, "%s: %u corrupt, %u missing blocks skipped\n", path,
+                (unsigned)reader.badBlocks(), (unsigned)reader.missingBlocks());
+    }
+    return true;
+}
+
+bool loadReplayFile(const char* path, std::vector<ReplaySample_t>& out) {
+    if (endsWith(path, ".mevc")) return loadCapture(path, out);
+    return endsWith(path, ".bin") ? loadRecorderDump(path, out) : loadCsv(path, out);
+}
@@ -0,0 +1,19 @@
+/**
+ * MOD-EVAC-MS - Replay File Loading
+ * Sensor recordings for the native builds (sim and emulator).
+ *
+ * .mevc - raw stream capture (capture_format.h) saved by sensor_worker.py
+ * .bin - flight-recorder dump saved by sensor_worker.py (18-byte samples,
+ *        accel in cm/s^2, gyro in mrad/s)
+ * other - CSV rows t_ms,water_raw,ax,ay,az,gx,gy,gz (m/s^2, rad/s);
+ *        header and comment lines are skipped
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "../src/hal/hal_posix.h"
+
+// Appends the samples in `path` to `out`. False if the file can't be opened.
+bool loadReplayFile(const char* path, std::vector<ReplaySample_t>& out);
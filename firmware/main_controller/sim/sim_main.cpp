@@ -0,0 +1,118 @@
+/**
+ * MOD-EVAC-MS - Native Controller Simulation
+ * Runs the unmodified controller application (app.cpp) on Linux through
+ * hal_posix.cpp. The host JSON link is stdin/stdout, so the backend or a
+ * shell pipe can drive it exactly like the USB serial port.
+ *
+ * Usage:
+ *   program [--replay FILE] [--loop] [--speed X] [--duration S] [--gsm-log FILE]
+ *           [--imu-fault START_S:END_S]
+ *   program --replay FILE --offline [--rules '[[ch,op,thr,hyst,hold_ms,alert],...]']
+ *
+ * --replay takes a .mevc capture, a flight-recorder .bin dump or a CSV
+ * (see replay_file.h). Without --replay the sensors read a dry, level,
+ * motionless board. --offline skips the tasks and runs the detection
+ * pipeline deterministically over the file (offline_replay.h).
+ * --imu-fault makes the IMU NACK between two virtual times, as if it had
+ * been unplugged, to exercise the lost / recovery / restored path.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "../src/app.h"
+#include "../src/hal/hal_posix.h"
+#include "offline_replay.h"
+#include "replay_file.h"
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main(int argc, char** argv) {
+    const char* replayPath = NULL;
+    const char* gsmLogPath = NULL;
+    const char* rulesJson = NULL;
+    bool offline = false;
+    double speed = 1.0;
+    double durationS = 0;
+    bool loop = false;
+    double faultFromS = 0, faultUntilS = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--replay") && i + 1 < argc) replayPath = argv[++i];
+        else if (!strcmp(argv[i], "--gsm-log") && i + 1 < argc) gsmLogPath = argv[++i];
+        else if (!strcmp(argv[i], "--speed") && i + 1 < argc) speed = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--duration") && i + 1 < argc) durationS = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--rules") && i + 1 < argc) rulesJson = argv[++i];
+        else if (!strcmp(argv[i], "--imu-fault") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%lf:%lf", &faultFromS, &faultUntilS) != 2) faultFromS = faultUntilS = 0;
+        }
+        else if (!strcmp(argv[i], "--loop")) loop = true;
+        else if (!strcmp(argv[i], "--offline")) offline = true;
+        else {
+            fprintf(stderr, "usage: %s [--replay FILE] [--loop] [--speed X] [--duration S] [--gsm-log FILE]\n"
+                            "          [--imu-fault START_S:END_S]\n"
+                            "       %s --replay FILE --offline [--rules JSON]\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (speed <= 0) speed = 1.0;
+
+    std::vector<ReplaySample_t> samples;
+    if (replayPath) {
+        if (!loadReplayFile(replayPath, samples) || samples.empty()) {
+            fprintf(stderr, "sim: no samples in %s\n", replayPath);
+            return 1;
+        }
+    }
+    if (offline) {
+        if (!replayPath) {
+            fprintf(stderr, "sim: --offline needs --replay\n");
+            return 2;
+        }
+        return runOfflineReplay(samples, rulesJson);
+    }
+
+    int gsmFd = -1;
+    if (gsmLogPath) {
+        gsmFd = open(gsmLogPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (gsmFd < 0) {
+            perror(gsmLogPath);
+            return 1;
+        }
+    }
+
+    HalPosixConfig_t config = {};
+    config.speed = speed;
+    config.hostInFd = STDIN_FILENO;
+    config.hostOutFd = STDOUT_FILENO;
+    config.gsmOutFd = gsmFd;
+    config.samples = samples.empty() ? NULL : samples.data();
+    config.sampleCount = samples.size();
+    config.loop = loop;
+    config.imuFaultFromMs = (uint32_t)(faultFromS * 1000.0);
+    config.imuFaultUntilMs = (uint32_t)(faultUntilS * 1000.0);
+    halPosixConfigure(config);
+
+    appSetup();
+
+    // Run until the duration elapses or a one-shot replay has been consumed
+    uint32_t startMs = halMillis();
+    for (;;) {
+        halDelayMs(100);
+        if (durationS > 0 && (halMillis() - startMs) >= (uint32_t)(durationS * 1000.0)) break;
+        if (!durationS && replayPath && !loop && halPosixReplayFinished()) break;
+    }
+
+    fprintf(stderr, "sim: %lu ms virtual, %zu samples, %lu led frames\n",
+            (unsigned long)(halMillis() - startMs), samples.size(), (unsigned long)halPosixLedFrames());
+
+    // Tasks never return; skip static destructors while they are still running
+    fflush(stdout);
+    _exit(0);
+}
@@ -0,0 +1,1399 @@
+/**
+ * MOD-EVAC-MS - Main Controller Application
+ * Alert state machine, sensor/LED/serial tasks and the host protocol.
+ *
+ * Talks to hardware only through hal/hal.h, so the same code runs on the
+ * ESP32 (main.cpp + hal_esp32.cpp) and natively on Linux (sim/ +
+ * hal_posix.cpp) against recorded sensor data.
+ *
+ * Communication: USB Serial JSON (115200 baud)
+ * No WiFi dependency - fully local operation
+ */
+
+#include "app.h"
+
+#include <ArduinoJson.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hal/hal.h"
+#include "i2c_health.h"
+#include "flight_recorder.h"
+#include "capture_format.h"
+#include "rules_engine.h"
+#include "link_watchdog.h"
+#include "channel_stats.h"
+#include "vibration_fft.h"
+#include "ground_motion.h"
+#include "water_trend.h"
+#include "runtime_stats.h"
+#include "led_patterns.h"
+#include "sensor_convert.h"
+#include "sensor_pipeline.h"
+#include "telemetry.h"
+#include "command.h"
+#include "base64.h"
+
+// ============================================================================
+// LINK CONFIGURATION (pins live in hal/hal_esp32.cpp, zones in led_patterns.h)
+// ============================================================================
+#define HOST_BAUD           115200
+#define GSM_BAUD            9600    // SIM800L or similar
+#define GSM_RING_MS         30000   // Emergency call rings this long, then ATH
+
+// ============================================================================
+// FLIGHT RECORDER CONFIGURATION
+// Full-rate samples kept around hazard events (PSRAM when available)
+// ============================================================================
+#define SENSOR_PERIOD_MS        20      // 50Hz acquisition
+#define RECORDER_PRE_MS         10000   // History kept before the trigger
+#define RECORDER_POST_MS        5000    // Recorded after the trigger
+#define RECORDER_CHUNK_SAMPLES  16      // Samples per rec_chunk line
+#define RECORDER_CHUNK_PERIOD_MS 100    // Throttle so telemetry keeps the link
+#define TELEMETRY_PERIOD_MS     100     // 10Hz telemetry
+
+// ============================================================================
+// VIBRATION ANALYSIS
+// ============================================================================
+#define VIB_REPORT_FLOOR_MS2    0.05f   // Spectra below this total RMS are not sent
+
+// ============================================================================
+// WATER RATE OF RISE
+// ============================================================================
+#define WATER_TREND_REPORT_MS   10000   // "water_trend" period while rising
+
+// ============================================================================
+// RUNTIME STATISTICS
+// ============================================================================
+#define STATS_PERIOD_MS         5000    // Period of the "stats" record
+#define STATS_MISS_TOLERANCE_US 1000    // Sensor wake later than period + this = deadline miss
+
+// "agg" record: type/ts/window_ms/n/ch, then five floats per channel. A
+// float prints in at most 15 chars ("-1.23456789e-10"), so a channel
+// object with its name stays under AGG_CHANNEL_CHARS.
+#define AGG_DOC_SIZE            (JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(NUM_CHANNELS) \
+                                 + NUM_CHANNELS * JSON_OBJECT_SIZE(5))
+#define AGG_CHANNEL_CHARS       144
+#define AGG_LINE_MAX            (96 + NUM_CHANNELS * AGG_CHANNEL_CHARS)
+
+// ============================================================================
+// ALERT STATES
+// ============================================================================
+typedef enum {
+    ALERT_SAFE = 0,         // Solid green
+    ALERT_CALLING,          // Pulsing amber
+    ALERT_MESSAGING,        // Slow blue pulse
+    ALERT_DANGER,           // Fast red blink
+    ALERT_EVACUATE          // Chase pattern toward exit
+} AlertState_t;
+static_assert(ALERT_EVACUATE == RULE_ALERT_MAX, "rules_engine.h validates alerts against ALERT_EVACUATE");
+
+// ============================================================================
+// GLOBAL STATE
+// ============================================================================
+Rgb_t ledFrame[LED_COUNT];
+uint8_t ledBrightness = 128;
+
+// Host JSON link and GSM UART
+HalLink& hostLink = halHostLink();
+HalLink& gsmLink = halGsmLink();
+uint32_t telemetryPeriodMs = TELEMETRY_PERIOD_MS;
+
+// Current system state
+volatile AlertState_t currentAlert = ALERT_SAFE;
+volatile int activeZone = -1;  // -1 = all zones, 0-3 = specific zone
+
+// Sensor readings (updated by sensor task). Fixed point: Q15 water and
+// IMU counts; converted to engineering units only when telemetry is encoded.
+volatile q15_t waterQ15 = 0;
+ImuRaw_t imuLatest = {};
+ImuScale_t imuScale;
+
+// IMU bus health and hot-reconnect schedule (sensor task only, read under the mutex)
+I2cDeviceHealth imuHealth;
+
+// Flight recorder (storage allocated in setup)
+FlightRecorder recorder;
+
+// Raw stream capture to the host (capture_start / capture_stop)
+CaptureStream capture;
+uint16_t captureSession = 0;
+
+// On-device hazard rules (loaded from NVS in setup)
+RulesEngine hazardRules;
+
+// Emergency call in progress (serialTask only); hung up by serviceGsmCall
+bool gsmCallActive = false;
+uint32_t gsmCallStartMs = 0;
+
+// Host link supervision (failsafe mode when the backend goes silent)
+LinkWatchdog linkWatchdog;
+volatile AlertState_t failsafeMaxAlert = ALERT_SAFE;
+
+// Windowed per-channel aggregates of the full-rate stream ("agg" records)
+ChannelStats channelStats;
+float channelScales[NUM_CHANNELS];
+
+// Per-sample analyzers and channel vector (owned by sensorTask; water
+// threshold set from the rules under the mutex)
+SensorPipeline sensorPipeline;
+
+// Vibration spectrum of the dynamic acceleration (latest result handed to
+// serialTask under the mutex)
+VibSpectrum_t vibLatest;
+bool vibPending = false;
+
+// PGA/PGV and intensity (level changes handed to serialTask under the mutex)
+GroundMotion_t groundLatest;
+uint8_t groundPrevLevel = 1;
+bool groundPending = false;
+
+// Water rate of rise / time to the DANGER threshold
+WaterTrend_t waterLatest;
+bool waterRisingChanged = false;
+uint32_t waterReportMs = 0;
+
+// Runtime instrumentation (guarded by halCritical*, reported by serialTask)
+PeriodMonitor sensorPeriodStats;
+DurationMonitor sensorWorkStats;
+DurationMonitor ledFrameStats;
+
+// Task handles
+HalTask sensorTaskHandle = NULL;
+HalTask ledTaskHandle = NULL;
+HalTask serialTaskHandle = NULL;
+
+// Mutex for thread-safe sensor access
+HalMutex sensorMutex;
+
+// ============================================================================
+// FUNCTION PROTOTYPES
+// ============================================================================
+void sensorTask(void *parameter);
+void ledTask(void *parameter);
+void serialTask(void *parameter);
+void runEvacuationPattern(int exitZone);
+void parseCommand(const char* json);
+void gsmCall(const char* number);
+void gsmSendSms(const char* number, const char* message);
+void gsmSendCommand(const char* cmd);
+void serviceGsmCall();
+void initFlightRecorder();
+void serviceRecorderDump();
+void serviceCapture();
+void setAlertState(AlertState_t state);
+void ledWait(uint32_t ms);
+void loadHazardRules();
+bool saveHazardRules();
+void serviceRuleEvents();
+void initLinkWatchdog();
+void serviceLinkEvents();
+void showFrame();
+void clearFrame();
+void reportRuntimeStats();
+void serviceSensorEvents();
+void initChannelStats();
+void serviceChannelStats();
+void serviceVibration();
+void serviceGroundMotion();
+void serviceWaterTrend();
+void applyWaterTrendThreshold();
+
+// ============================================================================
+// SETUP
+// ============================================================================
+void appSetTelemetryPeriod(uint32_t ms) {
+    // serialTask polls every 10 ms, so faster periods would not be honoured
+    telemetryPeriodMs = (ms < 10) ? 10 : ms;
+}
+
+void appSetup() {
+    // Initialize Serial for communication
+    halHostLinkBegin(HOST_BAUD);
+    
+    hostLink.println("{\"event\":\"boot\",\"status\":\"initializing\"}");
+    
+    // Initialize GSM Serial
+    halGsmBegin(GSM_BAUD);
+    hostLink.println("{\"event\":\"init\",\"component\":\"gsm\",\"status\":\"ok\"}");
+    
+    // Initialize MPU6050 (I2C). A missing sensor is re-probed in the
+    // background by sensorTask, so boot carries on either way.
+    bool imuPresent = halImuBegin();
+    imuHealth.begin(imuPresent, halMillis());
+    imuScale = halImuScale();
+    if (!imuPresent) {
+        hostLink.println("{\"event\":\"error\",\"component\":\"mpu6050\",\"message\":\"init_failed\",\"retrying\":true}");
+    } else {
+        hostLink.println("{\"event\":\"init\",\"component\":\"mpu6050\",\"status\":\"ok\"}");
+    }
+    
+    // Initialize water sensor pin
+    halWaterBegin();
+    hostLink.println("{\"event\":\"init\",\"component\":\"water_sensor\",\"status\":\"ok\"}");
+    
+    // Initialize LED strip
+    halLedBegin();
+    hostLink.print("{\"event\":\"init\",\"component\":\"led_strip\",\"leds\":");
+    hostLink.print(LED_COUNT);
+    hostLink.print(",\"zones\":");
+    hostLink.print(NUM_ZONES);
+    hostLink.println("}");
+    
+    // Create mutex
+    // I added this mutex to prevent race conditions between the High-Frequency Sensor Task (Core 0)
+    // and the Serial Telemetry Task (Core 1), ensuring that JSON packets are never corrupted.
+    sensorMutex = halMutexCreate();
+    
+    initFlightRecorder();
+    loadHazardRules();
+    applyWaterTrendThreshold();
+    initLinkWatchdog();
+    initChannelStats();
+    
+    // Create tasks on different cores for true parallelism
+    // I pinned the Sensor Task to Core 0 to isolate the interrupt-heavy I2C operations suitable for MPU6050 polling.
+    sensorTaskHandle = halTaskCreate(
+        sensorTask,         // Task function
+        "SensorTask",       // Name
+        4096,               // Stack size
+        2,                  // Priority (higher = more important)
+        0                   // Core 0
+    );
+    
+    ledTaskHandle = halTaskCreate(ledTask, "LEDTask", 4096, 1, 1);
+    
+    // Highest priority for command processing
+    serialTaskHandle = halTaskCreate(serialTask, "SerialTask", 8192, 3, 0);
+    
+    // Boot animation - green sweep
+    for (int i = 0; i < LED_COUNT; i++) {
+        ledFrame[i] = RGB_GREEN;
+        showFrame();
+        halDelayMs(20);
+    }
+    halDelayMs(500);
+    clearFrame();
+    showFrame();
+    
+    hostLink.println("{\"event\":\"boot\",\"status\":\"complete\",\"ready\":true}");
+}
+
+// ============================================================================
+// SENSOR TASK - Core 0
+// Reads water sensor and gyroscope at 50Hz
+// ============================================================================
+void sensorTask(void *parameter) {
+    ImuRaw_t imu = {};
+    const RecorderScaleQ_t recorderScale = recorderScaleQ(imuScale);
+    RecorderSample_t sample;
+    uint8_t intensityLevel = 1;
+    AlertState_t lastAlert = ALERT_SAFE;
+    uint32_t lastWakeTime = halTickCount();
+    
+    sensorPeriodStats.begin(SENSOR_PERIOD_MS * 1000UL, STATS_MISS_TOLERANCE_US);
+    sensorPipeline.begin(1000.0f / SENSOR_PERIOD_MS, imuScale);
+    
+    while (true) {
+        uint32_t wakeUs = halMicros();
+        halCriticalEnter();
+        sensorPeriodStats.tick(wakeUs);
+        halCriticalExit();
+        
+        // Read water sensor (analog 0-4095)
+        int rawWater = halWaterRead();
+        q15_t water = waterQ15FromRaw(rawWater);
+        
+        // Read MPU6050 (one bounded 14-byte burst of counts).
+        // While it is offline only the scheduled recovery touches the bus,
+        // and the last good values are held.
+        // The health object is only written by this task, under the mutex.
+        uint32_t nowMs = halMillis();
+        bool imuRead = imuHealth.online();
+        bool imuProbe = !imuRead && imuHealth.recoveryDue(nowMs);
+        I2cResult_t imuResult = I2C_OK;
+        bool imuRecovered = false;
+        if (imuRead) {
+            ImuRaw_t next;
+            imuResult = halImuRead(&next);
+            if (imuResult == I2C_OK) imu = next;
+        } else if (imuProbe) {
+            imuRecovered = halImuRecover();
+        }
+        
+        // Compact copy for the flight recorder (cm/s^2, mrad/s, raw ADC)
+        packRecorderSampleQ(&sample, halMillis(), rawWater, imu, recorderScale);
+        
+        // Raw stream capture keeps the counts themselves
+        CaptureSample_t captured = { sample.tMs, {}, {}, (uint16_t)rawWater };
+        memcpy(captured.accel, imu.accel, sizeof(captured.accel));
+        memcpy(captured.gyro, imu.gyro, sizeof(captured.gyro));
+        
+        // Analyzers and the channel vector for the rules engine, outside the lock
+        int32_t channels[NUM_CHANNELS];
+        PipelineEvents_t ev = sensorPipeline.process(water, imu, sample.tMs, channels);
+        
+        // Thread-safe update of global state
+        if (halMutexTake(sensorMutex, 5)) {
+            if (imuRead) imuHealth.record(imuResult, nowMs);
+            if (imuProbe) imuHealth.recordRecovery(imuRecovered, nowMs);
+            waterQ15 = water;
+            imuLatest = imu;
+            recorder.push(sample);
+            capture.push(captured);
+            channelStats.add(channels, sample.tMs);
+            if (ev.vibReady) {
+                vibLatest = sensorPipeline.spectrum();
+                vibPending = true;
+            }
+            if (ev.intensityChanged) {
+                // A change not yet reported keeps its original "from" level
+                if (!groundPending) groundPrevLevel = intensityLevel;
+                groundLatest = sensorPipeline.ground();
+                groundPending = true;
+                intensityLevel = groundLatest.level;
+            }
+            if (ev.waterFitted) {
+                waterLatest = sensorPipeline.water();
+                if (ev.waterRisingChanged) waterRisingChanged = true;
+            }
+            
+            // Rules only escalate; in failsafe the alert latches until the
+            // link returns
+            if (linkWatchdog.poll(sample.tMs)) {
+                failsafeMaxAlert = currentAlert;
+            }
+            uint8_t ruleAlert = escalateAlert(hazardRules, linkWatchdog, channels, sample.tMs, currentAlert);
+            if (ruleAlert > (uint8_t)currentAlert) {
+                setAlertState((AlertState_t)ruleAlert);
+            }
+            if (linkWatchdog.failover() && currentAlert > failsafeMaxAlert) {
+                failsafeMaxAlert = currentAlert;
+            }
+            
+            // Escalation into DANGER/EVACUATE is the local recorder trigger
+            AlertState_t alertNow = currentAlert;
+            if (alertNow >= ALERT_DANGER && lastAlert < ALERT_DANGER) {
+                recorder.trigger(REC_SRC_LOCAL);
+            }
+            lastAlert = alertNow;
+            halMutexGive(sensorMutex);
+        }
+        
+        halCriticalEnter();
+        sensorWorkStats.add(halMicros() - wakeUs);
+        halCriticalExit();
+        
+        // Wait for next period (precise timing)
+        halDelayUntil(&lastWakeTime, SENSOR_PERIOD_MS);  // 50Hz
+    }
+}
+
+// ============================================================================
+// LED TASK - Core 1
+// Handles LED patterns based on current alert state.
+// Waits are task notifications so an alert change re-renders immediately.
+// ============================================================================
+void ledTask(void *parameter) {
+    uint8_t brightness = 0;
+    bool increasing = true;
+    
+    while (true) {
+        AlertState_t state = currentAlert;
+        
+        switch (state) {
+            case ALERT_SAFE:
+                // Solid green on all zones
+                fillAllZones(ledFrame, RGB_GREEN);
+                showFrame();
+                ledWait(100);
+                break;
+                
+            case ALERT_CALLING:
+                // Pulsing amber
+                if (increasing) {
+                    brightness += 5;
+                    if (brightness >= 250) increasing = false;
+                } else {
+                    brightness -= 5;
+                    if (brightness <= 10) increasing = true;
+                }
+                ledBrightness = brightness;
+                fillAllZones(ledFrame, RGB_AMBER);
+                showFrame();
+                ledWait(20);
+                break;
+                
+            case ALERT_MESSAGING:
+                // Slow blue pulse
+                if (increasing) {
+                    brightness += 2;
+                    if (brightness >= 200) increasing = false;
+                } else {
+                    brightness -= 2;
+                    if (brightness <= 20) increasing = true;
+                }
+                ledBrightness = brightness;
+                fillAllZones(ledFrame, RGB_BLUE);
+                showFrame();
+                ledWait(30);
+                break;
+                
+            case ALERT_DANGER:
+                // Fast red blink
+                fillAllZones(ledFrame, RGB_RED);
+                ledBrightness = 255;
+                showFrame();
+                ledWait(100);
+                clearFrame();
+                showFrame();
+                ledWait(100);
+                break;
+                
+            case ALERT_EVACUATE:
+                // Chase pattern toward exit (Zone 3)
+                runEvacuationPattern(EXIT_ZONE);
+                ledWait(50);
+                break;
+                
+            default:
+                // Unknown level: keep the last frame, never spin
+                ledWait(100);
+                break;
+        }
+    }
+}
+
+// ============================================================================
+// SERIAL TASK - Core 0
+// Handles incoming commands and sends telemetry
+// ============================================================================
+void serialTask(void *parameter) {
+    char inputBuffer[512];
+    int bufferIndex = 0;
+    uint32_t lastTelemetry = halTickCount();
+    uint32_t lastStats = halTickCount();
+    
+    while (true) {
+        // Check for incoming commands
+        while (hostLink.available()) {
+            char c = hostLink.read();
+            if (c == '\n' || c == '\r') {
+                if (bufferIndex > 0) {
+                    inputBuffer[bufferIndex] = '\0';
+                    parseCommand(inputBuffer);
+                    bufferIndex = 0;
+                }
+            } else if (bufferIndex < (int)sizeof(inputBuffer) - 1) {
+                inputBuffer[bufferIndex++] = c;
+            }
+        }
+        
+        // Send telemetry at fixed rate
+        if ((halTickCount() - lastTelemetry) >= telemetryPeriodMs) {
+            TelemetrySnapshot_t snap;
+            char line[TELEMETRY_MAX_LEN];
+            
+            // Copy under the lock, scale and encode outside it
+            if (halMutexTake(sensorMutex, 5)) {
+                q15_t water = waterQ15;
+                ImuRaw_t imu = imuLatest;
+                snap.alert = (uint8_t)currentAlert;
+                snap.imuOk = imuHealth.online();
+                snap.imuErrors = imuHealth.errors();
+                snap.ts = halMillis();
+                halMutexGive(sensorMutex);
+                
+                snap.water = waterPercentFromQ15(water);
+                imuToSi(imu, imuScale, snap.accel, snap.gyro);
+                size_t len = encodeTelemetry(snap, line, sizeof(line));
+                if (len > 0) {
+                    hostLink.write((const uint8_t*)line, len);
+                    hostLink.println();
+                }
+            }
+            
+            lastTelemetry = halTickCount();
+        }
+        
+        // Periodic runtime instrumentation record
+        if ((halTickCount() - lastStats) >= STATS_PERIOD_MS) {
+            reportRuntimeStats();
+            lastStats = halTickCount();
+        }
+        
+        // Hang up an emergency call once it has rung long enough
+        serviceGsmCall();
+        
+        // Report rules that switched the alert locally
+        serviceRuleEvents();
+        
+        // Report host link failover / recovery
+        serviceLinkEvents();
+        
+        // Report IMU loss / hot-reconnect
+        serviceSensorEvents();
+        
+        // Emit a closed statistics window
+        serviceChannelStats();
+        
+        // Emit the latest vibration spectrum when there is shaking
+        serviceVibration();
+        
+        // Report intensity level changes
+        serviceGroundMotion();
+        
+        // Report water rate of rise / time to danger while rising
+        serviceWaterTrend();
+        
+        // Stream a frozen recorder window in the gaps between telemetry
+        serviceRecorderDump();
+        
+        // Stream raw capture blocks while a capture session is open
+        serviceCapture();
+        
+        halDelayMs(10);
+    }
+}
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+void runEvacuationPattern(int exitZone) {
+    static uint8_t phase = 0;
+    
+    composeEvacuationFrame(ledFrame, exitZone, phase);
+    showFrame();
+    phase++;
+}
+
+void parseCommand(const char* json) {
+    Command_t cmd;
+    
+    if (!decodeCommand(json, &cmd)) {
+        hostLink.println("{\"event\":\"error\",\"message\":\"json_parse_failed\"}");
+        return;
+    }
+    if (cmd.type == CMD_NONE) return;
+    
+    // Any valid command proves the host is alive
+    if (halMutexTake(sensorMutex, 5)) {
+        linkWatchdog.feed(halMillis());
+        halMutexGive(sensorMutex);
+    }
+    
+    switch (cmd.type) {
+        case CMD_SET_ALERT:
+            if (cmd.alert >= ALERT_SAFE && cmd.alert <= ALERT_EVACUATE) {
+                setAlertState((AlertState_t)cmd.alert);
+                hostLink.print("{\"event\":\"alert_set\",\"alert\":");
+                hostLink.print(cmd.alert);
+                hostLink.println("}");
+            }
+            break;
+            
+        case CMD_SET_ZONE:
+            if (cmd.zone >= 0 && cmd.zone < NUM_ZONES) {
+                fillZone(ledFrame, cmd.zone, Rgb_t{ cmd.r, cmd.g, cmd.b });
+                showFrame();
+                hostLink.print("{\"event\":\"zone_set\",\"zone\":");
+                hostLink.print(cmd.zone);
+                hostLink.println("}");
+            }
+            break;
+            
+        case CMD_GSM_CALL:
+            if (cmd.number[0]) {
+                gsmCall(cmd.number);
+                hostLink.print("{\"event\":\"gsm_call\",\"number\":\"");
+                hostLink.print(cmd.number);
+                hostLink.println("\"}");
+            }
+            break;
+            
+        case CMD_GSM_SMS:
+            if (cmd.number[0] && cmd.message[0]) {
+                gsmSendSms(cmd.number, cmd.message);
+                hostLink.print("{\"event\":\"gsm_sms\",\"number\":\"");
+                hostLink.print(cmd.number);
+                hostLink.println("\"}");
+            }
+            break;
+            
+        case CMD_RULES_SET: {
+            bool loaded = false;
+            if (cmd.rulesValid && halMutexTake(sensorMutex, 50)) {
+                loaded = hazardRules.load(cmd.rules, cmd.ruleCount);
+                if (loaded) applyWaterTrendThreshold();
+                halMutexGive(sensorMutex);
+            }
+            if (loaded && saveHazardRules()) {
+                hostLink.print("{\"event\":\"rules_set\",\"count\":");
+                hostLink.print(cmd.ruleCount);
+                hostLink.println("}");
+            } else {
+                hostLink.println("{\"event\":\"error\",\"component\":\"rules\",\"message\":\"rules_rejected\"}");
+            }
+            break;
+        }
+            
+        case CMD_RULES_GET:
+            hostLink.print("{\"event\":\"rules\",\"rules\":[");
+            for (uint8_t i = 0; i < hazardRules.count(); i++) {
+                const HazardRule_t& r = hazardRules.rule(i);
+                if (i > 0) hostLink.print(",");
+                hostLink.print("[");
+                hostLink.print(r.channel);
+                hostLink.print(",");
+                hostLink.print(r.op);
+                hostLink.print(",");
+                hostLink.print(r.threshold, 3);
+                hostLink.print(",");
+                hostLink.print(r.hysteresis, 3);
+                hostLink.print(",");
+                hostLink.print((unsigned long)r.holdMs);
+                hostLink.print(",");
+                hostLink.print(r.alert);
+                hostLink.print("]");
+            }
+            hostLink.println("]}");
+            break;
+            
+        case CMD_LINK_CONFIG: {
+            // Without timeout_ms this just reports the current timeout
+            if (cmd.timeoutMs && halMutexTake(sensorMutex, 5)) {
+                linkWatchdog.setTimeout(cmd.timeoutMs);
+                halMutexGive(sensorMutex);
+                uint32_t timeoutMs = linkWatchdog.timeoutMs();
+                halStorePut("link_to", &timeoutMs, sizeof(timeoutMs));
+            }
+            hostLink.print("{\"event\":\"link_config\",\"timeout_ms\":");
+            hostLink.print((unsigned long)linkWatchdog.timeoutMs());
+            hostLink.println("}");
+            break;
+        }
+        
+        case CMD_STATS_CONFIG: {
+            // Without window_ms this just reports the current window
+            if (cmd.windowMs && halMutexTake(sensorMutex, 5)) {
+                channelStats.setWindow(cmd.windowMs);
+                halMutexGive(sensorMutex);
+                uint32_t windowMs = channelStats.windowMs();
+                halStorePut("stats_win", &windowMs, sizeof(windowMs));
+            }
+            hostLink.print("{\"event\":\"stats_config\",\"window_ms\":");
+            hostLink.print((unsigned long)channelStats.windowMs());
+            hostLink.println("}");
+            break;
+        }
+            
+        case CMD_REC_TRIGGER: {
+            bool accepted = false;
+            if (halMutexTake(sensorMutex, 5)) {
+                accepted = recorder.trigger(REC_SRC_HOST);
+                halMutexGive(sensorMutex);
+            }
+            hostLink.print("{\"event\":\"rec_trigger\",\"accepted\":");
+            hostLink.print(accepted ? "true" : "false");
+            hostLink.print(",\"state\":");
+            hostLink.print((int)recorder.state());
+            hostLink.println("}");
+            break;
+        }
+            
+        case CMD_CAPTURE_START: {
+            CaptureHeader_t header = {};
+            header.samplePeriodMs = SENSOR_PERIOD_MS;
+            header.waterAdcMax = WATER_ADC_MAX;
+            header.accelScale = imuScale.accel;
+            header.gyroScale = imuScale.gyro;
+            header.startMs = halMillis();
+            if (halMutexTake(sensorMutex, 5)) {
+                header.sessionId = ++captureSession;
+                capture.start(header);
+                halMutexGive(sensorMutex);
+            }
+            hostLink.print("{\"event\":\"capture_start\",\"session\":");
+            hostLink.print(capture.sessionId());
+            hostLink.println("}");
+            break;
+        }
+            
+        case CMD_CAPTURE_STOP:
+            if (halMutexTake(sensorMutex, 5)) {
+                capture.stop();
+                halMutexGive(sensorMutex);
+            }
+            break;
+            
+        case CMD_PING:
+            hostLink.print("{\"event\":\"pong\",\"uptime\":");
+            hostLink.print((unsigned long)halMillis());
+            hostLink.println("}");
+            break;
+            
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// ALERT STATE
+// ============================================================================
+
+void setAlertState(AlertState_t state) {
+    currentAlert = state;
+    // Wake the LED task so the new pattern starts this tick
+    halNotify(ledTaskHandle);
+}
+
+// Pushes the frame buffer to the strip and records the frame time
+void showFrame() {
+    uint32_t startUs = halMicros();
+    halLedShow(ledFrame, LED_COUNT, ledBrightness);
+    uint32_t elapsed = halMicros() - startUs;
+    halCriticalEnter();
+    ledFrameStats.add(elapsed);
+    halCriticalExit();
+}
+
+void clearFrame() {
+    memset(ledFrame, 0, sizeof(ledFrame));
+}
+
+// LED pacing delay that returns early on an alert change
+void ledWait(uint32_t ms) {
+    halNotifyWait(ms);
+}
+
+// ============================================================================
+// HAZARD RULES (NVS persistence + host notification)
+// ============================================================================
+
+void loadHazardRules() {
+    // Thresholds compile against the IMU range in use
+    float scales[NUM_CHANNELS];
+    sensorChannelScales(imuScale, scales);
+    hazardRules.setScales(scales);
+    
+    uint8_t blob[RULES_BLOB_BYTES];
+    size_t len = halStoreGet("rules", blob, sizeof(blob));
+    
+    if (len > 0 && hazardRules.deserialize(blob, len)) {
+        hostLink.print("{\"event\":\"init\",\"component\":\"rules\",\"source\":\"nvs\",\"count\":");
+        hostLink.print(hazardRules.count());
+        hostLink.println("}");
+        return;
+    }
+    
+    hazardRules.load(DEFAULT_HAZARD_RULES, DEFAULT_HAZARD_RULE_COUNT);
+    hostLink.print("{\"event\":\"init\",\"component\":\"rules\",\"source\":\"default\",\"count\":");
+    hostLink.print(hazardRules.count());
+    hostLink.println("}");
+}
+
+// The water trend predicts the time to the highest-alert water rule.
+// Called at boot and with the mutex held on rules_set.
+void applyWaterTrendThreshold() {
+    float percent;
+    int32_t threshold = -1;
+    if (hazardRules.highestThreshold(CH_WATER, RULE_ABOVE, &percent)) {
+        threshold = (int32_t)(percent * (Q15_ONE / 100.0f) + 0.5f);
+    }
+    sensorPipeline.setWaterThreshold(threshold);
+}
+
+bool saveHazardRules() {
+    uint8_t blob[RULES_BLOB_BYTES];
+    size_t len = hazardRules.serialize(blob, sizeof(blob));
+    if (len == 0) return false;
+    
+    return halStorePut("rules", blob, len);
+}
+
+// Called from serialTask: tells the host which rule switched the alert
+// and when, after the LEDs have already reacted.
+void serviceRuleEvents() {
+    uint32_t fired = 0, cleared = 0;
+    if (halMutexTake(sensorMutex, 5)) {
+        fired = hazardRules.takeFired();
+        cleared = hazardRules.takeCleared();
+        halMutexGive(sensorMutex);
+    }
+    
+    for (uint8_t i = 0; i < hazardRules.count(); i++) {
+        if (fired & (1UL << i)) {
+            const HazardRule_t& r = hazardRules.rule(i);
+            hostLink.print("{\"event\":\"rule_fired\",\"rule\":");
+            hostLink.print(i);
+            hostLink.print(",\"channel\":");
+            hostLink.print(r.channel);
+            hostLink.print(",\"alert\":");
+            hostLink.print(r.alert);
+            hostLink.print(",\"value\":");
+            hostLink.print(hazardRules.firedValue(i), 3);
+            hostLink.print(",\"ts\":");
+            hostLink.print((unsigned long)hazardRules.firedAtMs(i));
+            hostLink.println("}");
+        }
+        if (cleared & (1UL << i)) {
+            hostLink.print("{\"event\":\"rule_cleared\",\"rule\":");
+            hostLink.print(i);
+            hostLink.print(",\"ts\":");
+            hostLink.print(halMillis());
+            hostLink.println("}");
+        }
+    }
+}
+
+// ============================================================================
+// HOST LINK WATCHDOG
+// ============================================================================
+
+void initLinkWatchdog() {
+    uint32_t timeoutMs = LINK_TIMEOUT_DEFAULT_MS;
+    if (halStoreGet("link_to", &timeoutMs, sizeof(timeoutMs)) != sizeof(timeoutMs)) {
+        timeoutMs = LINK_TIMEOUT_DEFAULT_MS;
+    }
+    
+    linkWatchdog.begin(timeoutMs, halMillis());
+    hostLink.print("{\"event\":\"init\",\"component\":\"link_watchdog\",\"timeout_ms\":");
+    hostLink.print((unsigned long)linkWatchdog.timeoutMs());
+    hostLink.println("}");
+}
+
+// Called from serialTask. link_lost is best effort (nobody may be listening);
+// link_restored carries the measured failover figures for the backend.
+void serviceLinkEvents() {
+    bool lost = false, restored = false;
+    if (halMutexTake(sensorMutex, 5)) {
+        lost = linkWatchdog.takeLost();
+        restored = linkWatchdog.takeRestored();
+        halMutexGive(sensorMutex);
+    }
+    
+    if (lost) {
+        hostLink.print("{\"event\":\"link_lost\",\"silent_ms\":");
+        hostLink.print((unsigned long)linkWatchdog.detectMs());
+        hostLink.print(",\"timeout_ms\":");
+        hostLink.print((unsigned long)linkWatchdog.timeoutMs());
+        hostLink.println("}");
+    }
+    if (restored) {
+        hostLink.print("{\"event\":\"link_restored\",\"detect_ms\":");
+        hostLink.print((unsigned long)linkWatchdog.detectMs());
+        hostLink.print(",\"timeout_ms\":");
+        hostLink.print((unsigned long)linkWatchdog.timeoutMs());
+        hostLink.print(",\"outage_ms\":");
+        hostLink.print((unsigned long)linkWatchdog.lastOutageMs());
+        hostLink.print(",\"failovers\":");
+        hostLink.print((unsigned long)linkWatchdog.failovers());
+        hostLink.print(",\"max_alert\":");
+        hostLink.print((int)failsafeMaxAlert);
+        hostLink.print(",\"alert\":");
+        hostLink.print((int)currentAlert);
+        hostLink.println("}");
+    }
+}
+
+// ============================================================================
+// CHANNEL STATISTICS
+// ============================================================================
+
+void initChannelStats() {
+    uint32_t windowMs = STATS_WINDOW_DEFAULT_MS;
+    if (halStoreGet("stats_win", &windowMs, sizeof(windowMs)) != sizeof(windowMs)) {
+        windowMs = STATS_WINDOW_DEFAULT_MS;
+    }
+    
+    sensorChannelScales(imuScale, channelScales);
+    channelStats.begin(windowMs, halMillis());
+    hostLink.print("{\"event\":\"init\",\"component\":\"channel_stats\",\"window_ms\":");
+    hostLink.print((unsigned long)channelStats.windowMs());
+    hostLink.println("}");
+}
+
+// Called from serialTask. One "agg" record per closed window, scaled to
+// engineering units here: {"type":"agg","ts":..,"window_ms":..,"n":..,
+// "ch":{"water":{"min":..,"max":..,"mean":..,"rms":..,"p2p":..},...}}
+void serviceChannelStats() {
+    ChannelWindow_t w;
+    bool ready = false;
+    if (halMutexTake(sensorMutex, 5)) {
+        ready = channelStats.take(&w);
+        halMutexGive(sensorMutex);
+    }
+    if (!ready || w.count == 0) return;
+    
+    StaticJsonDocument<AGG_DOC_SIZE> doc;
+    doc["type"] = "agg";
+    doc["ts"] = w.endMs;
+    doc["window_ms"] = w.endMs - w.startMs;
+    doc["n"] = w.count;
+    
+    JsonObject ch = doc.createNestedObject("ch");
+    for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+        if (w.n[c] == 0) continue;      // e.g. water_eta while not rising
+        float scale = channelScales[c];
+        JsonObject o = ch.createNestedObject(SENSOR_CHANNEL_NAMES[c]);
+        o["min"] = w.min[c] * scale;
+        o["max"] = w.max[c] * scale;
+        o["mean"] = channelMean(w, c) * scale;
+        o["rms"] = channelRms(w, c) * scale;
+        o["p2p"] = (float)(w.max[c] - w.min[c]) * scale;
+    }
+    
+    // serialTask only; kept off its stack
+    static char line[AGG_LINE_MAX];
+    if (doc.overflowed() || measureJson(doc) >= sizeof(line)) {
+        hostLink.println("{\"event\":\"error\",\"message\":\"agg_overflow\"}");
+        return;
+    }
+    size_t len = serializeJson(doc, line, sizeof(line));
+    hostLink.write((const uint8_t*)line, len);
+    hostLink.println();
+}
+
+// ============================================================================
+// VIBRATION ANALYSIS
+// ============================================================================
+
+// Called from serialTask. One "vibration" record per analysis window with
+// any shaking above the noise floor:
+// {"type":"vibration","ts":..,"dom_hz":..,"dom_rms":..,"rms":..,
+//  "bands":{"low":..,"quake":..,"high":..},"quake_ratio":..,"crest":..,"quake":bool}
+void serviceVibration() {
+    VibSpectrum_t s;
+    bool pending = false;
+    if (halMutexTake(sensorMutex, 5)) {
+        pending = vibPending;
+        vibPending = false;
+        s = vibLatest;
+        halMutexGive(sensorMutex);
+    }
+    if (!pending || s.totalRms < VIB_REPORT_FLOOR_MS2) return;
+    
+    StaticJsonDocument<384> doc;
+    doc["type"] = "vibration";
+    doc["ts"] = s.tMs;
+    doc["dom_hz"] = s.dominantHz;
+    doc["dom_rms"] = s.dominantRms;
+    doc["rms"] = s.totalRms;
+    JsonObject bands = doc.createNestedObject("bands");
+    bands["low"] = s.bandRms[VIB_BAND_LOW];
+    bands["quake"] = s.bandRms[VIB_BAND_QUAKE];
+    bands["high"] = s.bandRms[VIB_BAND_HIGH];
+    doc["quake_ratio"] = s.quakeRatio;
+    doc["crest"] = s.crest;
+    doc["quake"] = vibQuakeLevel(s) > 0.0f;
+    
+    char line[384];
+    size_t len = serializeJson(doc, line, sizeof(line));
+    if (len < sizeof(line)) {
+        hostLink.write((const uint8_t*)line, len);
+        hostLink.println();
+    }
+}
+
+// ============================================================================
+// WATER RATE OF RISE
+// ============================================================================
+
+// Called from serialTask. A "water_trend" record when the water starts or
+// stops rising, and every WATER_TREND_REPORT_MS while it rises:
+// {"type":"water_trend","ts":..,"level":%,"rate":%/min,"eta_s":..,"rising":bool}
+// eta_s is left out when the level is not heading for the threshold.
+void serviceWaterTrend() {
+    WaterTrend_t t = {};
+    bool changed = false;
+    if (halMutexTake(sensorMutex, 5)) {
+        changed = waterRisingChanged;
+        waterRisingChanged = false;
+        t = waterLatest;
+        halMutexGive(sensorMutex);
+    }
+    uint32_t now = halMillis();
+    bool due = t.rising && (now - waterReportMs) >= WATER_TREND_REPORT_MS;
+    if (!changed && !due) return;
+    waterReportMs = now;
+    
+    StaticJsonDocument<192> doc;
+    doc["type"] = "water_trend";
+    doc["ts"] = t.tMs;
+    doc["level"] = t.level;
+    doc["rate"] = t.ratePctMin;
+    if (t.etaS != WATER_TREND_ETA_NONE_S) doc["eta_s"] = t.etaS;
+    doc["rising"] = t.rising;
+    
+    char line[192];
+    size_t len = serializeJson(doc, line, sizeof(line));
+    if (len < sizeof(line)) {
+        hostLink.write((const uint8_t*)line, len);
+        hostLink.println();
+    }
+}
+
+// ============================================================================
+// GROUND MOTION / INTENSITY
+// ============================================================================
+
+// Called from serialTask. One event per reported intensity level change:
+// {"event":"intensity","level":..,"prev":..,"mmi":..,"pga":cm/s^2,"pgv":cm/s,"ts":..}
+void serviceGroundMotion() {
+    GroundMotion_t gm;
+    uint8_t prev = 1;
+    bool pending = false;
+    if (halMutexTake(sensorMutex, 5)) {
+        pending = groundPending;
+        groundPending = false;
+        gm = groundLatest;
+        prev = groundPrevLevel;
+        halMutexGive(sensorMutex);
+    }
+    if (!pending) return;
+    
+    StaticJsonDocument<192> doc;
+    doc["event"] = "intensity";
+    doc["level"] = gm.level;
+    doc["prev"] = prev;
+    doc["mmi"] = gm.mmi;
+    doc["pga"] = gm.pga;
+    doc["pgv"] = gm.pgv;
+    doc["ts"] = gm.tMs;
+    
+    char line[192];
+    size_t len = serializeJson(doc, line, sizeof(line));
+    if (len < sizeof(line)) {
+        hostLink.write((const uint8_t*)line, len);
+        hostLink.println();
+    }
+}
+
+// ============================================================================
+// SENSOR HEALTH
+// ============================================================================
+
+// Called from serialTask. sensor_lost fires once when the IMU goes offline
+// (readings are held from then on); sensor_restored once a background
+// re-probe has brought it back.
+void serviceSensorEvents() {
+    bool lost = false, restored = false;
+    I2cDeviceHealth health;
+    if (halMutexTake(sensorMutex, 5)) {
+        lost = imuHealth.takeLost();
+        restored = imuHealth.takeRestored();
+        health = imuHealth;
+        halMutexGive(sensorMutex);
+    }
+    
+    if (lost) {
+        hostLink.print("{\"event\":\"sensor_lost\",\"component\":\"mpu6050\",\"errors\":");
+        hostLink.print((unsigned long)health.errors());
+        hostLink.print(",\"ts\":");
+        hostLink.print((unsigned long)health.lastErrorMs);
+        hostLink.println("}");
+    }
+    if (restored) {
+        hostLink.print("{\"event\":\"sensor_restored\",\"component\":\"mpu6050\",\"probes\":");
+        hostLink.print((unsigned long)health.probes);
+        hostLink.print(",\"recoveries\":");
+        hostLink.print((unsigned long)health.recoveries);
+        hostLink.println("}");
+    }
+}
+
+// ============================================================================
+// RUNTIME STATISTICS
+// ============================================================================
+
+// Emits one "stats" record and resets the window counters. Per-task CPU
+// needs run-time stats from the HAL (FreeRTOS config on ESP32); without
+// them "cpu" is -1.
+void reportRuntimeStats() {
+    PeriodMonitor period;
+    DurationMonitor work, frames;
+    I2cDeviceHealth imu;
+    if (halMutexTake(sensorMutex, 5)) {
+        imu = imuHealth;
+        halMutexGive(sensorMutex);
+    }
+    halCriticalEnter();
+    period = sensorPeriodStats;
+    work = sensorWorkStats;
+    frames = ledFrameStats;
+    sensorPeriodStats.reset();
+    sensorWorkStats.reset();
+    ledFrameStats.reset();
+    halCriticalExit();
+    
+    const HalTask handles[] = { sensorTaskHandle, ledTaskHandle, serialTaskHandle };
+    const char* names[] = { "sensor", "led", "serial" };
+    const uint8_t numTasks = sizeof(handles) / sizeof(handles[0]);
+    float cpu[numTasks] = { -1.0f, -1.0f, -1.0f };
+    
+    static uint32_t lastTotal = 0;
+    static uint32_t lastRun[numTasks] = { 0 };
+    uint32_t run[numTasks];
+    uint32_t total = 0;
+    if (halTaskRuntime(handles, numTasks, run, &total)) {
+        uint32_t totalDelta = total - lastTotal;
+        for (uint8_t t = 0; t < numTasks; t++) {
+            if (lastTotal && totalDelta) cpu[t] = (100.0f * (run[t] - lastRun[t])) / totalDelta;
+            lastRun[t] = run[t];
+        }
+        lastTotal = total;
+    }
+    
+    StaticJsonDocument<768> doc;
+    doc["type"] = "stats";
+    doc["ts"] = halMillis();
+    doc["heap"] = halFreeHeap();
+    doc["heap_min"] = halMinFreeHeap();
+    
+    JsonArray tasks = doc.createNestedArray("tasks");
+    for (uint8_t t = 0; t < numTasks; t++) {
+        JsonObject task = tasks.createNestedObject();
+        task["name"] = names[t];
+        task["cpu"] = cpu[t];
+        task["stack_free"] = halTaskStackFree(handles[t]);
+    }
+    
+    JsonObject sensor = doc.createNestedObject("sensor");
+    sensor["period_us"] = SENSOR_PERIOD_MS * 1000UL;
+    sensor["samples"] = period.samples;
+    sensor["misses"] = period.misses;
+    sensor["max_dev_us"] = period.maxDevUs;
+    sensor["work_mean_us"] = work.meanUs();
+    sensor["work_max_us"] = work.maxUs;
+    JsonArray jitter = sensor.createNestedArray("jitter");
+    for (uint8_t i = 0; i < JITTER_BINS; i++) jitter.add(period.hist[i]);
+    
+    JsonObject i2c = doc.createNestedObject("imu");
+    i2c["online"] = imu.online();
+    i2c["reads"] = imu.reads;
+    i2c["nacks"] = imu.nacks;
+    i2c["timeouts"] = imu.timeouts;
+    i2c["bus_errors"] = imu.busErrors;
+    i2c["probes"] = imu.probes;
+    i2c["recoveries"] = imu.recoveries;
+    i2c["backoff_ms"] = imu.backoffMs();
+    
+    JsonObject led = doc.createNestedObject("led");
+    led["frames"] = frames.count;
+    led["mean_us"] = frames.meanUs();
+    led["max_us"] = frames.maxUs;
+    
+    char line[768];
+    size_t len = serializeJson(doc, line, sizeof(line));
+    if (len < sizeof(line)) {
+        hostLink.write((const uint8_t*)line, len);
+        hostLink.println();
+    }
+}
+
+// ============================================================================
+// FLIGHT RECORDER
+// ============================================================================
+
+void initFlightRecorder() {
+    const uint16_t pre = RECORDER_PRE_MS / SENSOR_PERIOD_MS;
+    const uint16_t post = RECORDER_POST_MS / SENSOR_PERIOD_MS;
+    const uint16_t capacity = pre + post;
+    const size_t bytes = (size_t)capacity * sizeof(RecorderSample_t);
+    
+    // Prefer PSRAM so the ring does not compete with task stacks
+    bool inPsram = false;
+    RecorderSample_t* storage = (RecorderSample_t*)halAllocLarge(bytes, &inPsram);
+    
+    if (!storage || !recorder.begin(storage, capacity, pre, post)) {
+        hostLink.println("{\"event\":\"error\",\"component\":\"recorder\",\"message\":\"alloc_failed\"}");
+        return;
+    }
+    
+    hostLink.print("{\"event\":\"init\",\"component\":\"recorder\",\"samples\":");
+    hostLink.print(capacity);
+    hostLink.print(",\"bytes\":");
+    hostLink.print((unsigned long)bytes);
+    hostLink.print(",\"psram\":");
+    hostLink.print(inPsram ? "true" : "false");
+    hostLink.println("}");
+}
+
+// Called from serialTask only, so recorder output never interleaves with
+// telemetry lines. Emits rec_frozen, then one rec_chunk per throttle period,
+// then rec_done and re-arms the ring.
+void serviceRecorderDump() {
+    static bool announced = false;
+    static uint16_t offset = 0;
+    static uint16_t seq = 0;
+    static uint32_t lastChunk = 0;
+    
+    if (recorder.state() != REC_FROZEN) return;
+    
+    if (!announced) {
+        hostLink.print("{\"event\":\"rec_frozen\",\"id\":");
+        hostLink.print(recorder.eventId());
+        hostLink.print(",\"source\":\"");
+        hostLink.print(recorder.source() == REC_SRC_HOST ? "host" : "local");
+        hostLink.print("\",\"samples\":");
+        hostLink.print(recorder.windowLength());
+        hostLink.print(",\"trigger_index\":");
+        hostLink.print(recorder.triggerOffset());
+        hostLink.print(",\"trigger_ts\":");
+        hostLink.print((unsigned long)recorder.triggerTimeMs());
+        hostLink.print(",\"rate_hz\":");
+        hostLink.print(1000 / SENSOR_PERIOD_MS);
+        hostLink.print(",\"sample_bytes\":");
+        hostLink.print(RECORDER_SAMPLE_BYTES);
+        hostLink.println("}");
+        announced = true;
+        offset = 0;
+        seq = 0;
+        lastChunk = halTickCount();
+        return;
+    }
+    
+    if ((halTickCount() - lastChunk) < RECORDER_CHUNK_PERIOD_MS) return;
+    lastChunk = halTickCount();
+    
+    RecorderSample_t samples[RECORDER_CHUNK_SAMPLES];
+    uint8_t packed[RECORDER_CHUNK_SAMPLES * RECORDER_SAMPLE_BYTES];
+    char encoded[BASE64_LEN(sizeof(packed)) + 1];
+    
+    uint16_t n = 0;
+    if (halMutexTake(sensorMutex, 5)) {
+        n = recorder.read(offset, samples, RECORDER_CHUNK_SAMPLES);
+        halMutexGive(sensorMutex);
+    } else {
+        return;  // Retry next period
+    }
+    
+    if (n > 0) {
+        size_t len = FlightRecorder::encodeSamples(samples, n, packed);
+        base64Encode(packed, len, encoded);
+        hostLink.print("{\"type\":\"rec_chunk\",\"id\":");
+        hostLink.print(recorder.eventId());
+        hostLink.print(",\"seq\":");
+        hostLink.print(seq++);
+        hostLink.print(",\"data\":\"");
+        hostLink.print(encoded);
+        hostLink.println("\"}");
+        offset += n;
+        return;
+    }
+    
+    // Window fully streamed; re-arm first so a missed mutex take retries
+    // the rearm, not the whole rec_done line
+    uint16_t id = recorder.eventId();
+    if (!halMutexTake(sensorMutex, 5)) return;
+    recorder.rearm();
+    halMutexGive(sensorMutex);
+    announced = false;
+    
+    hostLink.print("{\"event\":\"rec_done\",\"id\":");
+    hostLink.print(id);
+    hostLink.print(",\"chunks\":");
+    hostLink.print(seq);
+    hostLink.println("}");
+}
+
+// Streams one capture header or block per call so telemetry keeps the link,
+// then reports cap_done once a stopped session is fully drained
+void serviceCapture() {
+    uint8_t block[CAPTURE_BLOCK_MAX_BYTES];
+    char encoded[BASE64_LEN(CAPTURE_BLOCK_MAX_BYTES) + 1];
+    const char* type = "cap_block";
+    size_t len = 0;
+    bool finished = false;
+    
+    if (!halMutexTake(sensorMutex, 5)) return;
+    if (capture.takeHeader(block)) {
+        type = "cap_header";
+        len = CAPTURE_HEADER_BYTES;
+    } else {
+        len = capture.takeBlock(block);
+        if (len == 0) finished = capture.takeFinished();
+    }
+    uint16_t session = capture.sessionId();
+    uint32_t blocks = capture.blocks();
+    uint32_t dropped = capture.droppedBlocks();
+    halMutexGive(sensorMutex);
+    
+    if (len > 0) {
+        base64Encode(block, len, encoded);
+        hostLink.print("{\"type\":\"");
+        hostLink.print(type);
+        hostLink.print("\",\"session\":");
+        hostLink.print(session);
+        hostLink.print(",\"data\":\"");
+        hostLink.print(encoded);
+        hostLink.println("\"}");
+    } else if (finished) {
+        hostLink.print("{\"event\":\"cap_done\",\"session\":");
+        hostLink.print(session);
+        hostLink.print(",\"blocks\":");
+        hostLink.print((unsigned long)blocks);
+        hostLink.print(",\"dropped\":");
+        hostLink.print((unsigned long)dropped);
+        hostLink.println("}");
+    }
+}
+
+// ============================================================================
+// GSM FUNCTIONS (SIM800L AT Commands)
+// ============================================================================
+
+void gsmSendCommand(const char* cmd) {
+    gsmLink.println(cmd);
+    halDelayMs(100);
+}
+
+void gsmCall(const char* number) {
+    // A new call replaces one still ringing
+    if (gsmCallActive) gsmSendCommand("ATH");
+    
+    // ATD command to dial
+    char dialCmd[CMD_NUMBER_MAX + 8];
+    snprintf(dialCmd, sizeof(dialCmd), "ATD%s;", number);
+    gsmSendCommand(dialCmd);
+    hostLink.print("{\"event\":\"gsm_dialing\",\"number\":\"");
+    hostLink.print(number);
+    hostLink.println("\"}");
+    
+    // Hung up later from the serial loop: blocking here for the ring time
+    // would stop host commands being read and trip the link watchdog
+    gsmCallActive = true;
+    gsmCallStartMs = halMillis();
+}
+
+void serviceGsmCall() {
+    if (!gsmCallActive || (halMillis() - gsmCallStartMs) < GSM_RING_MS) return;
+    gsmCallActive = false;
+    gsmSendCommand("ATH");  // Hang up
+    hostLink.println("{\"event\":\"gsm_hangup\"}");
+}
+
+void gsmSendSms(const char* number, const char* message) {
+    // Set SMS text mode
+    gsmSendCommand("AT+CMGF=1");
+    halDelayMs(100);
+    
+    // Set recipient
+    char smsCmd[CMD_NUMBER_MAX + 16];
+    snprintf(smsCmd, sizeof(smsCmd), "AT+CMGS=\"%s\"", number);
+    gsmLink.println(smsCmd);
+    halDelayMs(100);
+    
+    // Send message content
+    gsmLink.print(message);
+    halDelayMs(100);
+    
+    // Send Ctrl+Z to transmit
+    gsmLink.write((uint8_t)26);
+    halDelayMs(1000);
+    
+    hostLink.print("{\"event\":\"gsm_sms_sent\",\"to\":\"");
+    hostLink.print(number);
+    hostLink.println("\"}");
+}
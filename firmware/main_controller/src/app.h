@@ -0,0 +1,16 @@
+/**
+ * MOD-EVAC-MS - Main Controller Application
+ * Platform-independent entry point; the HAL backend supplies the hardware.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Brings up the links and sensors, loads persisted config and starts the
+// sensor / LED / serial tasks. Returns once the boot animation is done.
+void appSetup();
+
+// Telemetry record period (default TELEMETRY_PERIOD_MS, minimum 10 ms).
+// Call before appSetup(); used by the native emulator for load tests.
+void appSetTelemetryPeriod(uint32_t ms);
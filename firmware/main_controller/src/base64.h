@@ -0,0 +1,38 @@
+/**
+ * MOD-EVAC-MS - Base64 encoder
+ * Used to carry binary payloads inside the JSON-lines serial protocol.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Output size for n input bytes, excluding the terminator
+#define BASE64_LEN(n)   ((((n) + 2) / 3) * 4)
+
+// Encodes len bytes into out and NUL-terminates it.
+// out must hold BASE64_LEN(len) + 1 bytes. Returns characters written.
+inline size_t base64Encode(const uint8_t* in, size_t len, char* out) {
+    static const char table[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    size_t i = 0;
+    for (; i + 2 < len; i += 3) {
+        uint32_t v = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8) | in[i + 2];
+        out[o++] = table[(v >> 18) & 0x3F];
+        out[o++] = table[(v >> 12) & 0x3F];
+        out[o++] = table[(v >> 6) & 0x3F];
+        out[o++] = table[v & 0x3F];
+    }
+    if (i < len) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        out[o++] = table[(v >> 18) & 0x3F];
+        out[o++] = table[(v >> 12) & 0x3F];
+        out[o++] = (i + 1 < len) ? table[(v >> 6) & 0x3F] : '=';
+        out[o++] = '=';
+    }
+    out[o] = '\0';
+    return o;
+}
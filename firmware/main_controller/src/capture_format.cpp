@@ -0,0 +1,243 @@
+/**
+ * MOD-EVAC-MS - Raw Sensor Capture Format (.mevc)
+ */
+
+#include "capture_format.h"
+
+#include <string.h>
+
+static const uint8_t CAPTURE_MAGIC[4] = { 'M', 'E', 'V', 'C' };
+
+// ============================================================================
+// LITTLE-ENDIAN HELPERS
+// ============================================================================
+static inline uint8_t* putU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t* putU32(uint8_t* p, uint32_t v) {
+    p = putU16(p, (uint16_t)v);
+    return putU16(p, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t getU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+static inline uint8_t* putF32(uint8_t* p, float v) {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    return putU32(p, u);
+}
+
+static inline float getF32(const uint8_t* p) {
+    uint32_t u = getU32(p);
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+// CRC-16/CCITT-FALSE
+uint16_t captureCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// ============================================================================
+// HEADER
+// ============================================================================
+size_t encodeCaptureHeader(const CaptureHeader_t& h, uint8_t* out) {
+    memset(out, 0, CAPTURE_HEADER_BYTES);
+    memcpy(out, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    out[4] = CAPTURE_VERSION;
+    out[5] = CAPTURE_HEADER_BYTES;
+    putU16(out + 6, h.samplePeriodMs);
+    putU16(out + 8, h.waterAdcMax);
+    putU16(out + 10, h.sessionId);
+    putF32(out + 12, h.accelScale);
+    putF32(out + 16, h.gyroScale);
+    putU32(out + 20, h.startMs);
+    putU16(out + 24, h.maxBlockSamples);
+    putU16(out + 30, captureCrc16(out, 30));
+    return CAPTURE_HEADER_BYTES;
+}
+
+bool decodeCaptureHeader(const uint8_t* in, size_t len, CaptureHeader_t* out) {
+    if (len < CAPTURE_HEADER_BYTES || memcmp(in, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) return false;
+    if (in[4] < CAPTURE_VERSION_MIN || in[4] > CAPTURE_VERSION || in[5] < CAPTURE_HEADER_BYTES) return false;
+    if (getU16(in + 30) != captureCrc16(in, 30)) return false;
+
+    out->version = in[4];
+    out->samplePeriodMs = getU16(in + 6);
+    out->waterAdcMax = getU16(in + 8);
+    out->sessionId = getU16(in + 10);
+    out->accelScale = getF32(in + 12);
+    out->gyroScale = getF32(in + 16);
+    out->startMs = getU32(in + 20);
+    out->maxBlockSamples = getU16(in + 24);
+    return true;
+}
+
+// ============================================================================
+// WRITER
+// ============================================================================
+void CaptureStream::start(const CaptureHeader_t& header) {
+    _header = header;
+    _header.version = CAPTURE_VERSION;
+    _header.maxBlockSamples = CAPTURE_BLOCK_SAMPLES;
+    _active = true;
+    _headerPending = true;
+    _finishPending = false;
+    _openCount = 0;
+    _seq = 0;
+    _dropped = 0;
+    _queueHead = 0;
+    _queueCount = 0;
+}
+
+void CaptureStream::stop() {
+    if (!_active) return;
+    closeBlock();
+    _active = false;
+    _finishPending = true;
+}
+
+void CaptureStream::push(const CaptureSample_t& s) {
+    if (!_active) return;
+
+    // The per-sample delta is one byte; a longer stall starts a new block
+    if (_openCount > 0 && (s.tMs - _lastMs) > 0xFF) closeBlock();
+
+    if (_openCount == 0) {
+        putU32(_open + 4, s.tMs);
+        _lastMs = s.tMs;
+    }
+
+    uint8_t* p = _open + 8 + _openCount * CAPTURE_SAMPLE_BYTES;
+    *p++ = (uint8_t)(s.tMs - _lastMs);
+    for (int k = 0; k < 3; k++) p = putU16(p, (uint16_t)s.accel[k]);
+    for (int k = 0; k < 3; k++) p = putU16(p, (uint16_t)s.gyro[k]);
+    putU16(p, s.water);
+    _lastMs = s.tMs;
+
+    if (++_openCount == CAPTURE_BLOCK_SAMPLES) closeBlock();
+}
+
+void CaptureStream::closeBlock() {
+    if (_openCount == 0) return;
+
+    size_t len = CAPTURE_BLOCK_BYTES(_openCount);
+    _open[0] = CAPTURE_BLOCK_SYNC;
+    _open[1] = _openCount;
+    putU16(_open + 2, _seq++);
+    putU16(_open + len - 2, captureCrc16(_open, len - 2));
+    _openCount = 0;
+
+    // Serial task fell behind: the seq gap tells the reader
+    if (_queueCount == CAPTURE_QUEUE_BLOCKS) {
+        _dropped++;
+        return;
+    }
+    uint8_t slot = (_queueHead + _queueCount) % CAPTURE_QUEUE_BLOCKS;
+    memcpy(_queue[slot], _open, len);
+    _queueLen[slot] = (uint16_t)len;
+    _queueCount++;
+}
+
+bool CaptureStream::takeHeader(uint8_t* out) {
+    if (!_headerPending) return false;
+    _headerPending = false;
+    encodeCaptureHeader(_header, out);
+    return true;
+}
+
+size_t CaptureStream::takeBlock(uint8_t* out) {
+    if (_headerPending || _queueCount == 0) return 0;
+    size_t len = _queueLen[_queueHead];
+    memcpy(out, _queue[_queueHead], len);
+    _queueHead = (_queueHead + 1) % CAPTURE_QUEUE_BLOCKS;
+    _queueCount--;
+    return len;
+}
+
+bool CaptureStream::takeFinished() {
+    if (!_finishPending || _queueCount > 0) return false;
+    _finishPending = false;
+    return true;
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+bool CaptureReader::begin(const uint8_t* data, size_t len) {
+    if (!decodeCaptureHeader(data, len, &_header)) return false;
+    _data = data;
+    _len = len;
+    _pos = data[5];
+    _blockCount = 0;
+    _blockIndex = 0;
+    _haveSeq = false;
+    _blocks = 0;
+    _badBlocks = 0;
+    _missing = 0;
+    return true;
+}
+
+bool CaptureReader::loadBlock() {
+    bool resyncing = false;
+    while (_pos + CAPTURE_BLOCK_BYTES(1) <= _len) {
+        const uint8_t* b = _data + _pos;
+        uint8_t count = b[1];
+        size_t len = CAPTURE_BLOCK_BYTES(count);
+
+        // A block cut off by the end of the file (power loss) ends the replay
+        if (!resyncing && b[0] == CAPTURE_BLOCK_SYNC && _pos + len > _len) return false;
+
+        if (b[0] != CAPTURE_BLOCK_SYNC || count == 0 || _pos + len > _len ||
+            getU16(b + len - 2) != captureCrc16(b, len - 2)) {
+            if (!resyncing) _badBlocks++;
+            resyncing = true;
+            _pos++;
+            continue;
+        }
+
+        uint16_t seq = getU16(b + 2);
+        if (_haveSeq) _missing += (uint16_t)(seq - _lastSeq - 1);
+        _haveSeq = true;
+        _lastSeq = seq;
+
+        _block = b;
+        _blockCount = count;
+        _blockIndex = 0;
+        _t = getU32(b + 4);
+        _pos += len;
+        _blocks++;
+        return true;
+    }
+    return false;
+}
+
+bool CaptureReader::next(CaptureSample_t* out) {
+    if (_blockIndex >= _blockCount && !loadBlock()) return false;
+
+    const uint8_t* p = _block + 8 + _blockIndex * CAPTURE_SAMPLE_BYTES;
+    _t += p[0];
+    out->tMs = _t;
+    for (int k = 0; k < 3; k++) out->accel[k] = (int16_t)getU16(p + 1 + 2 * k);
+    for (int k = 0; k < 3; k++) out->gyro[k] = (int16_t)getU16(p + 7 + 2 * k);
+    out->water = getU16(p + 13);
+    _blockIndex++;
+    return true;
+}
@@ -0,0 +1,147 @@
+/**
+ * MOD-EVAC-MS - Raw Sensor Capture Format (.mevc)
+ * Append-only binary recording of the full-rate sensor stream, written by
+ * the firmware (capture_start) and replayed by the native builds.
+ *
+ * Layout, all little-endian:
+ *   Header (32 bytes)
+ *     0  "MEVC"                4  u8 version        5  u8 header bytes
+ *     6  u16 sample period ms  8  u16 water ADC max  10 u16 session id
+ *     12 f32 accel m/s^2/LSB   16 f32 gyro rad/s/LSB 20 u32 start ms
+ *     24 u16 max block samples 26 u32 reserved      30 u16 CRC16
+ *   Blocks (10 + 15 * count bytes), repeated until end of file
+ *     0  u8 0xB5 sync          1  u8 sample count    2  u16 block seq
+ *     4  u32 first sample ms
+ *     8  per sample: u8 ms since previous (0 for first), i16 accel[3],
+ *        i16 gyro[3], u16 raw water
+ *     .. u16 CRC16 over the block
+ *
+ * Version 2 stores the IMU counts exactly as the sensor task read them,
+ * with the configured range's LSB sizes in the header, so a replay feeds
+ * the pipeline the same integers the device saw. Version 1 files (flight
+ * recorder units, 0.01 m/s^2 and 0.001 rad/s) still decode through their
+ * header scales.
+ *
+ * Every block stands alone, so a file cut short by a power loss or a
+ * dropped serial line still replays up to the last intact block, and a
+ * gap in seq shows exactly where blocks were lost.
+ *
+ * Pure C++, no Arduino dependency; the caller serialises access.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+#define CAPTURE_VERSION         2
+#define CAPTURE_VERSION_MIN     1       // Oldest version the reader accepts
+#define CAPTURE_HEADER_BYTES    32
+#define CAPTURE_BLOCK_SYNC      0xB5
+#define CAPTURE_BLOCK_SAMPLES   32
+#define CAPTURE_SAMPLE_BYTES    15
+#define CAPTURE_BLOCK_BYTES(n)  (10 + (n) * CAPTURE_SAMPLE_BYTES)
+#define CAPTURE_BLOCK_MAX_BYTES CAPTURE_BLOCK_BYTES(CAPTURE_BLOCK_SAMPLES)
+#define CAPTURE_QUEUE_BLOCKS    4       // Completed blocks waiting for the serial task
+
+typedef struct {
+    uint8_t version;
+    uint16_t samplePeriodMs;
+    uint16_t waterAdcMax;
+    uint16_t sessionId;
+    float accelScale;       // m/s^2 per LSB (mpuScale() of the configured range)
+    float gyroScale;        // rad/s per LSB
+    uint32_t startMs;
+    uint16_t maxBlockSamples;
+} CaptureHeader_t;
+
+typedef struct {
+    uint32_t tMs;
+    int16_t accel[3];       // IMU counts, CaptureHeader_t::accelScale
+    int16_t gyro[3];        // IMU counts, CaptureHeader_t::gyroScale
+    uint16_t water;         // Raw ADC
+} CaptureSample_t;
+
+uint16_t captureCrc16(const uint8_t* data, size_t len);
+
+size_t encodeCaptureHeader(const CaptureHeader_t& h, uint8_t* out);
+bool decodeCaptureHeader(const uint8_t* in, size_t len, CaptureHeader_t* out);
+
+// ============================================================================
+// WRITER (firmware: sensor task -> serial task)
+// ============================================================================
+class CaptureStream {
+public:
+    void start(const CaptureHeader_t& header);
+    void stop();            // Closes the open block so it is streamed too
+
+    // Sensor task side
+    void push(const CaptureSample_t& s);
+
+    // Serial task side
+    bool takeHeader(uint8_t* out);          // Once per session, CAPTURE_HEADER_BYTES
+    size_t takeBlock(uint8_t* out);         // Oldest completed block, 0 when none
+    bool takeFinished();                    // Stopped and fully drained
+
+    bool active() const { return _active; }
+    uint16_t sessionId() const { return _header.sessionId; }
+    uint32_t blocks() const { return _seq; }
+    uint32_t droppedBlocks() const { return _dropped; }
+
+private:
+    void closeBlock();
+
+    CaptureHeader_t _header = {};
+    bool _active = false;
+    bool _headerPending = false;
+    bool _finishPending = false;
+
+    uint8_t _open[CAPTURE_BLOCK_MAX_BYTES];
+    uint8_t _openCount = 0;
+    uint32_t _lastMs = 0;
+    uint16_t _seq = 0;
+    uint32_t _dropped = 0;
+
+    uint8_t _queue[CAPTURE_QUEUE_BLOCKS][CAPTURE_BLOCK_MAX_BYTES];
+    uint16_t _queueLen[CAPTURE_QUEUE_BLOCKS];
+    uint8_t _queueHead = 0;
+    uint8_t _queueCount = 0;
+};
+
+// ============================================================================
+// READER (host tools, replay)
+// ============================================================================
+class CaptureReader {
+public:
+    // False on a bad magic, version or header CRC
+    bool begin(const uint8_t* data, size_t len);
+
+    // Next sample in file order. Corrupt blocks are skipped by scanning for
+    // the next valid one; returns false at the end of the data.
+    bool next(CaptureSample_t* out);
+
+    const CaptureHeader_t& header() const { return _header; }
+    uint32_t blocks() const { return _blocks; }
+    uint32_t badBlocks() const { return _badBlocks; }
+    uint32_t missingBlocks() const { return _missing; }     // From seq gaps
+
+private:
+    bool loadBlock();
+
+    CaptureHeader_t _header = {};
+    const uint8_t* _data = nullptr;
+    size_t _len = 0;
+    size_t _pos = 0;
+
+    const uint8_t* _block = nullptr;
+    uint8_t _blockCount = 0;
+    uint8_t _blockIndex = 0;
+    uint32_t _t = 0;
+
+    bool _haveSeq = false;
+    uint16_t _lastSeq = 0;
+    uint32_t _blocks = 0;
+    uint32_t _badBlocks = 0;
+    uint32_t _missing = 0;
+};
@@ -0,0 +1,117 @@
+/**
+ * MOD-EVAC-MS - Windowed Channel Statistics
+ * Per-channel min / max / mean / RMS / peak-to-peak over fixed windows of
+ * the full-rate sample stream, so trending sees spikes that fall between
+ * 10 Hz telemetry snapshots at a fraction of the link volume.
+ *
+ * add() is O(1) per channel. Samples are integer channel LSBs
+ * (sensor_convert.h), so plain 64-bit sums and sums of squares are exact:
+ * there is no cancellation for a Welford update to guard against, and the
+ * hot path stays integer. Mean and RMS are derived once per window when
+ * the summary is emitted. Called under the caller's lock. Pure C++, no
+ * Arduino dependency.
+ *
+ * Samples that carry no value are left out of their channel only: the
+ * water ETA while the level is not rising (WATER_TREND_ETA_NONE_S) would
+ * otherwise pull a day-long sentinel into its max, mean and RMS. Each
+ * channel therefore keeps its own sample count.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+#include "rules_engine.h"
+#include "water_trend.h"
+
+#define STATS_WINDOW_DEFAULT_MS 10000
+#define STATS_WINDOW_MIN_MS     1000
+#define STATS_WINDOW_MAX_MS     3600000
+
+typedef struct {
+    uint32_t startMs;
+    uint32_t endMs;
+    uint32_t count;                 // Samples in the window
+    uint32_t n[NUM_CHANNELS];       // Samples that carried a value, per channel
+    int32_t min[NUM_CHANNELS];
+    int32_t max[NUM_CHANNELS];
+    int64_t sum[NUM_CHANNELS];
+    uint64_t sumSq[NUM_CHANNELS];
+} ChannelWindow_t;
+
+class ChannelStats {
+public:
+    void begin(uint32_t windowMs, uint32_t nowMs) {
+        setWindow(windowMs);
+        restart(nowMs);
+        _ready = false;
+    }
+
+    // Takes effect from the next window
+    void setWindow(uint32_t ms) {
+        if (ms < STATS_WINDOW_MIN_MS) ms = STATS_WINDOW_MIN_MS;
+        if (ms > STATS_WINDOW_MAX_MS) ms = STATS_WINDOW_MAX_MS;
+        _windowMs = ms;
+    }
+
+    // One sample. Closes the window once it has run its length; a closed
+    // window not yet taken is overwritten (the summaries are best effort).
+    void add(const int32_t* channels, uint32_t nowMs) {
+        if (_cur.count > 0 && (nowMs - _cur.startMs) >= _windowMs) {
+            _cur.endMs = nowMs;
+            _done = _cur;
+            _ready = true;
+            restart(nowMs);
+        }
+
+        for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+            int32_t v = channels[c];
+            if (c == CH_WATER_ETA && v == WATER_TREND_ETA_NONE_S) continue;
+            if (v < _cur.min[c]) _cur.min[c] = v;
+            if (v > _cur.max[c]) _cur.max[c] = v;
+            _cur.sum[c] += v;
+            _cur.sumSq[c] += (uint64_t)((int64_t)v * v);
+            _cur.n[c]++;
+        }
+        _cur.count++;
+    }
+
+    // Completed window for the serial task
+    bool take(ChannelWindow_t* out) {
+        if (!_ready) return false;
+        *out = _done;
+        _ready = false;
+        return true;
+    }
+
+    uint32_t windowMs() const { return _windowMs; }
+
+private:
+    void restart(uint32_t nowMs) {
+        _cur.startMs = nowMs;
+        _cur.endMs = nowMs;
+        _cur.count = 0;
+        for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+            _cur.n[c] = 0;
+            _cur.min[c] = INT32_MAX;
+            _cur.max[c] = INT32_MIN;
+            _cur.sum[c] = 0;
+            _cur.sumSq[c] = 0;
+        }
+    }
+
+    uint32_t _windowMs = STATS_WINDOW_DEFAULT_MS;
+    ChannelWindow_t _cur;
+    ChannelWindow_t _done;
+    bool _ready = false;
+};
+
+// Derived figures in channel LSBs (scale with sensorChannelScales)
+static inline float channelMean(const ChannelWindow_t& w, uint8_t c) {
+    return w.n[c] ? (float)w.sum[c] / w.n[c] : 0.0f;
+}
+
+static inline float channelRms(const ChannelWindow_t& w, uint8_t c) {
+    return w.n[c] ? sqrtf((float)w.sumSq[c] / w.n[c]) : 0.0f;
+}
@@ -0,0 +1,115 @@
+/**
+ * MOD-EVAC-MS - Host Command Decoding
+ */
+
+#include "command.h"
+
+#include <ArduinoJson.h>
+#include <string.h>
+
+static const struct {
+    const char* name;
+    CommandType_t type;
+} COMMAND_NAMES[] = {
+    { "set_alert",   CMD_SET_ALERT },
+    { "set_zone",    CMD_SET_ZONE },
+    { "gsm_call",    CMD_GSM_CALL },
+    { "gsm_sms",     CMD_GSM_SMS },
+    { "ping",        CMD_PING },
+    { "rules_set",   CMD_RULES_SET },
+    { "rules_get",   CMD_RULES_GET },
+    { "link_config", CMD_LINK_CONFIG },
+    { "rec_trigger", CMD_REC_TRIGGER },
+    { "capture_start", CMD_CAPTURE_START },
+    { "capture_stop", CMD_CAPTURE_STOP },
+    { "stats_config", CMD_STATS_CONFIG },
+};
+
+static void copyField(char* dst, size_t cap, const char* src) {
+    if (!src) {
+        dst[0] = '\0';
+        return;
+    }
+    size_t n = strlen(src);
+    if (n >= cap) n = cap - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+bool decodeCommand(const char* json, Command_t* out) {
+    StaticJsonDocument<1024> doc;  // Sized for a full rules_set table
+    DeserializationError error = deserializeJson(doc, json);
+    if (error) return false;
+
+    out->type = CMD_NONE;
+    const char* cmd = doc["cmd"];
+    if (!cmd) return true;
+
+    for (size_t i = 0; i < sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]); i++) {
+        if (strcmp(cmd, COMMAND_NAMES[i].name) == 0) {
+            out->type = COMMAND_NAMES[i].type;
+            break;
+        }
+    }
+
+    switch (out->type) {
+        case CMD_SET_ALERT:
+            out->alert = doc["alert"] | 0;
+            break;
+
+        case CMD_SET_ZONE:
+            out->zone = doc["zone"] | -1;
+            out->r = doc["r"] | 0;
+            out->g = doc["g"] | 0;
+            out->b = doc["b"] | 0;
+            break;
+
+        case CMD_GSM_CALL:
+        case CMD_GSM_SMS:
+            copyField(out->number, sizeof(out->number), doc["number"]);
+            copyField(out->message, sizeof(out->message), doc["message"]);
+            break;
+
+        case CMD_LINK_CONFIG:
+            out->timeoutMs = doc["timeout_ms"] | (uint32_t)0;
+            break;
+
+        case CMD_STATS_CONFIG:
+            out->windowMs = doc["window_ms"] | (uint32_t)0;
+            break;
+
+        case CMD_RULES_SET: {
+            // {"cmd":"rules_set","rules":[[channel,op,threshold,hysteresis,hold_ms,alert],...]}
+            JsonArray list = doc["rules"];
+            out->ruleCount = 0;
+            out->rulesValid = !list.isNull() && list.size() <= RULES_MAX;
+            if (!out->rulesValid) break;
+            for (JsonArray r : list) {
+                // Range-checked as ints: narrowing first would turn 256
+                // into channel 0 and 259 into DANGER
+                long channel = r[0] | -1L;
+                long op = r[1] | -1L;
+                long holdMs = r[4] | 0L;
+                long alert = r[5] | -1L;
+                if (channel < 0 || channel >= NUM_CHANNELS || op < RULE_ABOVE || op > RULE_BELOW
+                    || holdMs < 0 || alert < 0 || alert > RULE_ALERT_MAX) {
+                    out->rulesValid = false;
+                    break;
+                }
+                HazardRule_t& rule = out->rules[out->ruleCount++];
+                rule.channel = (uint8_t)channel;
+                rule.op = (uint8_t)op;
+                rule.threshold = r[2] | 0.0f;
+                rule.hysteresis = r[3] | 0.0f;
+                rule.holdMs = (uint32_t)holdMs;
+                rule.alert = (uint8_t)alert;
+                rule.reserved = 0;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    return true;
+}
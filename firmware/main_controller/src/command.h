@@ -0,0 +1,47 @@
+/**
+ * MOD-EVAC-MS - Host Command Decoding
+ * Turns one JSON command line into a plain struct. Validation that needs
+ * device state and all side effects stay in the firmware's parseCommand.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "rules_engine.h"
+
+#define CMD_NUMBER_MAX      24
+#define CMD_MESSAGE_MAX     161     // One SMS + terminator
+
+typedef enum {
+    CMD_NONE = 0,           // Valid JSON without a known "cmd"
+    CMD_SET_ALERT,
+    CMD_SET_ZONE,
+    CMD_GSM_CALL,
+    CMD_GSM_SMS,
+    CMD_PING,
+    CMD_RULES_SET,
+    CMD_RULES_GET,
+    CMD_LINK_CONFIG,
+    CMD_REC_TRIGGER,
+    CMD_CAPTURE_START,
+    CMD_CAPTURE_STOP,
+    CMD_STATS_CONFIG
+} CommandType_t;
+
+typedef struct {
+    CommandType_t type;
+    int alert;
+    int zone;
+    uint8_t r, g, b;
+    char number[CMD_NUMBER_MAX];        // Empty when absent
+    char message[CMD_MESSAGE_MAX];      // Empty when absent
+    uint32_t timeoutMs;                 // link_config, 0 when absent
+    uint32_t windowMs;                  // stats_config, 0 when absent
+    bool rulesValid;
+    uint8_t ruleCount;
+    HazardRule_t rules[RULES_MAX];
+} Command_t;
+
+// Returns false when the line is not valid JSON.
+bool decodeCommand(const char* json, Command_t* out);
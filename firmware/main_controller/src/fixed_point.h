@@ -0,0 +1,62 @@
+/**
+ * MOD-EVAC-MS - Fixed-Point Helpers
+ * Q15 / Q31 types and the few integer primitives the acquisition path
+ * needs. The ESP32 has no double FPU and a single-precision one that is
+ * slower than its integer multiplier, so samples stay integer from the
+ * ADC / I2C read to the host boundary. Pure C++, no Arduino dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef int16_t q15_t;      // Value / 32768
+typedef int32_t q31_t;      // Value / 2^31
+
+#define Q15_ONE             32767
+#define Q16_ONE             65536   // Multipliers: x * m >> 16
+
+static inline q15_t sat16(int32_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32767) return -32767;
+    return (q15_t)v;
+}
+
+static inline q15_t q15Mul(q15_t a, q15_t b) {
+    return (q15_t)(((int32_t)a * b + (1 << 14)) >> 15);
+}
+
+static inline q31_t q31Mul(q31_t a, q31_t b) {
+    return (q31_t)(((int64_t)a * b + (1LL << 30)) >> 31);
+}
+
+// x * m / 65536, rounded to nearest; m is a Q16 multiplier
+static inline int32_t mulQ16(int32_t x, int32_t m) {
+    return (int32_t)(((int64_t)x * m + 0x8000) >> 16);
+}
+
+// Q16 multiplier for a float factor, computed once at setup
+static inline int32_t toQ16(float f) {
+    return (int32_t)(f * (float)Q16_ONE + (f >= 0 ? 0.5f : -0.5f));
+}
+
+static inline int32_t iabs32(int32_t v) {
+    return v < 0 ? -v : v;
+}
+
+// floor(sqrt(v)), bit by bit: 16 iterations of shifts and adds
+static inline uint32_t isqrt32(uint32_t v) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
@@ -0,0 +1,95 @@
+/**
+ * MOD-EVAC-MS - Flight Recorder
+ */
+
+#include "flight_recorder.h"
+
+bool FlightRecorder::begin(RecorderSample_t* storage, uint16_t capacity,
+                           uint16_t preSamples, uint16_t postSamples) {
+    if (!storage || capacity == 0 || (uint32_t)preSamples + postSamples > capacity) {
+        _state = REC_DISABLED;
+        return false;
+    }
+    _buf = storage;
+    _capacity = capacity;
+    _preTarget = preSamples;
+    _postTarget = postSamples;
+    _head = 0;
+    _count = 0;
+    _state = REC_ARMED;
+    return true;
+}
+
+void FlightRecorder::push(const RecorderSample_t& sample) {
+    if (_state != REC_ARMED && _state != REC_TRIGGERED) return;
+
+    _buf[_head] = sample;
+    _head = (_head + 1) % _capacity;
+    if (_count < _capacity) _count++;
+
+    if (_state == REC_TRIGGERED) {
+        _postCollected++;
+        if (_postCollected >= _postTarget) {
+            _state = REC_FROZEN;
+        }
+    }
+}
+
+bool FlightRecorder::trigger(RecorderSource_t source) {
+    if (_state != REC_ARMED) return false;
+
+    // The window starts `pre` samples behind the write head. The ring is
+    // sized for pre + post, so post-trigger writes never reach it.
+    _pre = (_count < _preTarget) ? _count : _preTarget;
+    _windowStart = (uint16_t)((_head + _capacity - _pre) % _capacity);
+    _postCollected = 0;
+    _source = source;
+    _triggerMs = (_pre > 0) ? _buf[(_head + _capacity - 1) % _capacity].tMs : 0;
+    _eventId++;
+    _state = (_postTarget == 0) ? REC_FROZEN : REC_TRIGGERED;
+    return true;
+}
+
+uint16_t FlightRecorder::read(uint16_t offset, RecorderSample_t* out, uint16_t maxCount) const {
+    if (_state != REC_FROZEN) return 0;
+
+    uint16_t len = windowLength();
+    if (offset >= len) return 0;
+
+    uint16_t n = len - offset;
+    if (n > maxCount) n = maxCount;
+    for (uint16_t i = 0; i < n; i++) {
+        out[i] = _buf[(_windowStart + offset + i) % _capacity];
+    }
+    return n;
+}
+
+void FlightRecorder::rearm() {
+    if (_state == REC_DISABLED) return;
+    // Restart from an empty ring so the next window never contains
+    // samples from the previous event.
+    _head = 0;
+    _count = 0;
+    _pre = 0;
+    _postCollected = 0;
+    _state = REC_ARMED;
+}
+
+static inline uint8_t* putU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+size_t FlightRecorder::encodeSamples(const RecorderSample_t* samples, uint16_t count, uint8_t* out) {
+    uint8_t* p = out;
+    for (uint16_t i = 0; i < count; i++) {
+        const RecorderSample_t& s = samples[i];
+        p = putU16(p, (uint16_t)(s.tMs & 0xFFFF));
+        p = putU16(p, (uint16_t)(s.tMs >> 16));
+        for (int k = 0; k < 3; k++) p = putU16(p, (uint16_t)s.accel[k]);
+        for (int k = 0; k < 3; k++) p = putU16(p, (uint16_t)s.gyro[k]);
+        p = putU16(p, s.water);
+    }
+    return (size_t)(p - out);
+}
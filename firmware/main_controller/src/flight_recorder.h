@@ -0,0 +1,88 @@
+/**
+ * MOD-EVAC-MS - Flight Recorder
+ * Pre-trigger ring buffer of full-rate sensor samples.
+ *
+ * The sensor task pushes every sample into the ring. When a trigger arrives
+ * (local alert escalation or a host command) the recorder keeps the last
+ * `preSamples` samples, records `postSamples` more, then freezes the window
+ * so the serial task can stream it out in binary chunks.
+ *
+ * Pure C++ with no Arduino dependency. The caller owns the storage (internal
+ * RAM or PSRAM) and serialises access with its own mutex.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// SAMPLE FORMAT
+// Wire layout is 18 bytes little-endian, in field order (see encodeSamples)
+// ============================================================================
+#define RECORDER_SAMPLE_BYTES   18
+#define RECORDER_ACCEL_SCALE    0.01f   // m/s^2 per LSB
+#define RECORDER_GYRO_SCALE     0.001f  // rad/s per LSB
+
+typedef struct {
+    uint32_t tMs;           // millis() at acquisition
+    int16_t accel[3];       // cm/s^2
+    int16_t gyro[3];        // mrad/s
+    uint16_t water;         // Raw ADC counts (0-4095)
+} RecorderSample_t;
+
+typedef enum {
+    REC_DISABLED = 0,       // No storage attached
+    REC_ARMED,              // Continuously overwriting the ring
+    REC_TRIGGERED,          // Collecting post-trigger samples
+    REC_FROZEN              // Window locked, waiting to be streamed out
+} RecorderState_t;
+
+typedef enum {
+    REC_SRC_LOCAL = 0,      // Alert escalation seen on the device
+    REC_SRC_HOST            // rec_trigger command from the backend
+} RecorderSource_t;
+
+class FlightRecorder {
+public:
+    // Attach caller-owned storage. pre + post must fit in capacity.
+    bool begin(RecorderSample_t* storage, uint16_t capacity,
+               uint16_t preSamples, uint16_t postSamples);
+
+    // Writer side (sensor task)
+    void push(const RecorderSample_t& sample);
+    bool trigger(RecorderSource_t source);
+
+    // Reader side (serial task). Only valid while frozen.
+    uint16_t read(uint16_t offset, RecorderSample_t* out, uint16_t maxCount) const;
+    void rearm();
+
+    RecorderState_t state() const { return _state; }
+    RecorderSource_t source() const { return _source; }
+    uint16_t eventId() const { return _eventId; }
+    uint16_t windowLength() const { return _pre + _postCollected; }
+    uint16_t triggerOffset() const { return _pre; }
+    uint32_t triggerTimeMs() const { return _triggerMs; }
+    uint16_t capacity() const { return _capacity; }
+
+    // Pack samples into the 18-byte wire format. Returns bytes written.
+    static size_t encodeSamples(const RecorderSample_t* samples, uint16_t count, uint8_t* out);
+
+private:
+    RecorderSample_t* _buf = nullptr;
+    uint16_t _capacity = 0;
+    uint16_t _preTarget = 0;
+    uint16_t _postTarget = 0;
+
+    uint16_t _head = 0;             // Next write index
+    uint16_t _count = 0;            // Valid samples in ring (saturates at capacity)
+
+    uint16_t _windowStart = 0;      // Ring index of first frozen sample
+    uint16_t _pre = 0;              // Pre-trigger samples actually available
+    uint16_t _postCollected = 0;
+
+    uint16_t _eventId = 0;
+    uint32_t _triggerMs = 0;
+    RecorderSource_t _source = REC_SRC_LOCAL;
+    RecorderState_t _state = REC_DISABLED;
+};
@@ -0,0 +1,123 @@
+/**
+ * MOD-EVAC-MS - Ground Motion and Intensity
+ */
+
+#include "ground_motion.h"
+
+#include <math.h>
+
+#define TWO_PI_F            6.28318531f
+
+float mmiFromPeaks(float pgaCms2, float pgvCms) {
+    // Below the instrument floor the logs run away; I is "not felt"
+    if (pgaCms2 < 0.1f) return 1.0f;
+
+    float ia = 3.66f * log10f(pgaCms2) - 1.66f;
+    float mmi;
+    if (ia < 5.0f) {
+        mmi = 2.20f * log10f(pgaCms2) + 1.00f;
+    } else {
+        float iv = (pgvCms > 0.0f) ? 3.47f * log10f(pgvCms) + 2.35f : ia;
+        if (ia < 7.0f) {
+            float w = (ia - 5.0f) / 2.0f;
+            mmi = (1.0f - w) * ia + w * iv;
+        } else {
+            mmi = iv;
+        }
+    }
+
+    if (mmi < 1.0f) mmi = 1.0f;
+    if (mmi > 10.0f) mmi = 10.0f;
+    return mmi;
+}
+
+void GroundMotion::begin(float sampleHz, float accelUnitsPerLsb) {
+    _accelScale = accelUnitsPerLsb;
+    _alphaQ15 = (int32_t)(expf(-TWO_PI_F * GM_HIGHPASS_HZ / sampleHz) * 32768.0f);
+    _dtMs = (int32_t)(1000.0f / sampleHz + 0.5f);
+    _bucketSamples = (uint16_t)(sampleHz + 0.5f);
+    _inBucket = 0;
+    _primed = false;
+    _bucket = 0;
+    _bucketA2 = 0;
+    _bucketV2 = 0;
+    for (uint8_t b = 0; b < GM_WINDOW_BUCKETS; b++) {
+        _maxA2[b] = 0;
+        _maxV2[b] = 0;
+    }
+    _gm = { 0, 0.0f, 0.0f, 1.0f, 1.0f, 1 };
+    _levelChanged = false;
+}
+
+bool GroundMotion::push(const ImuRaw_t& imu, uint32_t tMs) {
+    if (!_primed) {
+        // Start the filters on the first sample so gravity is not a step
+        for (int k = 0; k < 3; k++) {
+            _prev[k] = imu.accel[k];
+            _hpQ8[k] = 0;
+            _vel[k] = 0;
+        }
+        _primed = true;
+    }
+
+    // A high-passed step can reach 2^16 counts per axis: square in 64 bits
+    uint64_t a2 = 0;
+    uint64_t v2 = 0;
+    for (int k = 0; k < 3; k++) {
+        int32_t x = imu.accel[k];
+
+        // y[n] = alpha * (y[n-1] + x[n] - x[n-1])
+        int64_t hp = (int64_t)_hpQ8[k] + (int64_t)(x - _prev[k]) * 256;
+        _hpQ8[k] = (int32_t)((hp * _alphaQ15) >> 15);
+        _prev[k] = x;
+
+        // v[n] = alpha * (v[n-1] + a[n] * dt)
+        int64_t v = (int64_t)_vel[k] + (((int64_t)_hpQ8[k] * _dtMs) >> 8);
+        _vel[k] = (int32_t)((v * _alphaQ15) >> 15);
+
+        int32_t a = _hpQ8[k] >> 8;
+        a2 += (uint64_t)((int64_t)a * a);
+        v2 += (uint64_t)((int64_t)_vel[k] * _vel[k]);
+    }
+
+    if (a2 > _bucketA2) _bucketA2 = a2;
+    if (v2 > _bucketV2) _bucketV2 = v2;
+
+    if (++_inBucket < _bucketSamples) return false;
+    closeBucket(tMs);
+    return true;
+}
+
+void GroundMotion::closeBucket(uint32_t tMs) {
+    _gm.bucketMmi = mmiFromPeaks(sqrtf((float)_bucketA2) * _accelScale * 100.0f,
+                                 sqrtf((float)_bucketV2) * _accelScale * 0.1f);
+    _maxA2[_bucket] = _bucketA2;
+    _maxV2[_bucket] = _bucketV2;
+    _bucket = (_bucket + 1) % GM_WINDOW_BUCKETS;
+    _bucketA2 = 0;
+    _bucketV2 = 0;
+    _inBucket = 0;
+
+    uint64_t a2 = 0;
+    uint64_t v2 = 0;
+    for (uint8_t b = 0; b < GM_WINDOW_BUCKETS; b++) {
+        if (_maxA2[b] > a2) a2 = _maxA2[b];
+        if (_maxV2[b] > v2) v2 = _maxV2[b];
+    }
+
+    // counts -> m/s^2 -> cm/s^2; counts * ms -> m/s -> cm/s
+    _gm.tMs = tMs;
+    _gm.pga = sqrtf((float)a2) * _accelScale * 100.0f;
+    _gm.pgv = sqrtf((float)v2) * _accelScale * 0.1f;
+    _gm.mmi = mmiFromPeaks(_gm.pga, _gm.pgv);
+
+    // Up as soon as the rounded intensity rises, down only with margin
+    uint8_t rounded = (uint8_t)(_gm.mmi + 0.5f);
+    if (rounded > _gm.level) {
+        _gm.level = rounded;
+        _levelChanged = true;
+    } else if (rounded < _gm.level && _gm.mmi < _gm.level - 0.5f - GM_MMI_HYSTERESIS) {
+        _gm.level = rounded;
+        _levelChanged = true;
+    }
+}
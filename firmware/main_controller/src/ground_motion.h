@@ -0,0 +1,78 @@
+/**
+ * MOD-EVAC-MS - Ground Motion and Intensity
+ * Peak ground acceleration / velocity over a sliding window and the
+ * instrumental intensity they imply, so alerts can key on a physical
+ * quantity instead of raw gyro numbers.
+ *
+ * Per sample (integer, O(1)): each accel axis goes through a DC-blocking
+ * high-pass (removes gravity and tilt), is integrated to velocity with a
+ * leaky integrator (a second high-pass against drift), and the squared
+ * vector magnitudes are folded into the current one-second bucket's
+ * maxima. Once per bucket the window maxima over the last
+ * GM_WINDOW_BUCKETS seconds are converted to PGA (cm/s^2), PGV (cm/s) and
+ * Modified Mercalli intensity after Wald et al. (1999). Intensity level
+ * changes are latched as one-shot events with hysteresis on the way down.
+ * The closed bucket's own intensity is kept too: one impact holds the
+ * window maximum for GM_WINDOW_BUCKETS seconds, so anything that must see
+ * shaking persist (rule hold times) keys on the per-bucket figure.
+ * Pure C++, no Arduino dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "mpu6050.h"
+
+#define GM_HIGHPASS_HZ      0.2f    // Gravity / tilt / integration drift corner
+#define GM_WINDOW_BUCKETS   10      // Sliding window, one bucket per second
+#define GM_MMI_HYSTERESIS   0.3f    // Level drops once MMI < level - 0.5 - this
+
+typedef struct {
+    uint32_t tMs;
+    float pga;              // cm/s^2, vector, gravity removed
+    float pgv;              // cm/s
+    float mmi;              // 1.0-10.0
+    float bucketMmi;        // Last one-second bucket alone
+    uint8_t level;          // Reported intensity level (rounded MMI, hysteresis)
+} GroundMotion_t;
+
+class GroundMotion {
+public:
+    void begin(float sampleHz, float accelUnitsPerLsb);
+
+    // One IMU sample (accel counts). Returns true when a bucket closed and
+    // current() has fresh window figures.
+    bool push(const ImuRaw_t& imu, uint32_t tMs);
+
+    const GroundMotion_t& current() const { return _gm; }
+
+    // One-shot: the reported intensity level changed
+    bool takeLevelChange() { bool v = _levelChanged; _levelChanged = false; return v; }
+
+private:
+    void closeBucket(uint32_t tMs);
+
+    float _accelScale = 1.0f;       // m/s^2 per count
+    int32_t _alphaQ15 = 32767;      // High-pass pole
+    int32_t _dtMs = 20;
+    uint16_t _bucketSamples = 50;
+    uint16_t _inBucket = 0;
+    bool _primed = false;
+
+    int32_t _prev[3] = {};          // Last input, counts
+    int32_t _hpQ8[3] = {};          // High-passed accel, counts Q8
+    int32_t _vel[3] = {};           // Velocity, counts * ms
+
+    uint64_t _bucketA2 = 0;         // Current bucket max |a|^2, counts^2
+    uint64_t _bucketV2 = 0;         // Current bucket max |v|^2, (counts * ms)^2
+    uint64_t _maxA2[GM_WINDOW_BUCKETS] = {};
+    uint64_t _maxV2[GM_WINDOW_BUCKETS] = {};
+    uint8_t _bucket = 0;
+
+    GroundMotion_t _gm = { 0, 0.0f, 0.0f, 1.0f, 1.0f, 1 };
+    bool _levelChanged = false;
+};
+
+// Wald et al. (1999): PGA-based below V, PGV-based from VII, blended between
+float mmiFromPeaks(float pgaCms2, float pgvCms);
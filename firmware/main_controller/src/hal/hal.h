@@ -0,0 +1,119 @@
+/**
+ * MOD-EVAC-MS - Main Controller Hardware Abstraction Layer
+ *
+ * Everything the controller logic (app.cpp) needs from the platform: clock,
+ * host serial link, GSM UART, LED strip, IMU, water ADC, RTOS primitives,
+ * NVS storage and diagnostics. Selected at link time:
+ *   hal_esp32.cpp - Arduino / FastLED / mpu6050_i2c burst reader / FreeRTOS
+ *   hal_posix.cpp - Linux threads, scaled clock, replayed sensor data
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../i2c_health.h"
+#include "../led_patterns.h"
+#include "../mpu6050.h"
+
+// ============================================================================
+// CLOCK
+// Tick values are milliseconds of the task scheduler clock.
+// ============================================================================
+uint32_t halMillis();
+uint32_t halMicros();
+uint32_t halTickCount();
+void halDelayMs(uint32_t ms);
+
+// ============================================================================
+// SERIAL LINKS (host JSON link and GSM UART)
+// Print-style helpers on top of a raw byte interface.
+// ============================================================================
+class HalLink {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t print(const char* s);
+    size_t print(int v);
+    size_t print(unsigned int v);
+    size_t print(long v);
+    size_t print(unsigned long v);
+    size_t print(double v, int digits = 2);
+    size_t println(const char* s = "");
+    size_t println(int v);
+    size_t println(unsigned long v);
+};
+
+void halHostLinkBegin(uint32_t baud);
+void halGsmBegin(uint32_t baud);
+HalLink& halHostLink();
+HalLink& halGsmLink();
+
+// ============================================================================
+// LED STRIP
+// ============================================================================
+void halLedBegin();
+void halLedShow(const Rgb_t* frame, uint16_t count, uint8_t brightness);
+
+// ============================================================================
+// SENSORS
+// ============================================================================
+// IMU samples are raw counts; halImuScale() converts (see imuToSi).
+// Reads are bounded and report why they failed; halImuRecover() clears
+// the bus and re-probes / reconfigures the part (hot-reconnect).
+bool halImuBegin();
+I2cResult_t halImuRead(ImuRaw_t* out);
+bool halImuRecover();
+ImuScale_t halImuScale();
+
+void halWaterBegin();
+int halWaterRead();         // Raw 12-bit ADC counts
+
+// ============================================================================
+// RTOS
+// ============================================================================
+typedef void* HalTask;
+typedef void* HalMutex;
+typedef void (*HalTaskFn)(void* parameter);
+
+// core < 0 means no affinity. Priorities follow FreeRTOS (higher = more urgent).
+HalTask halTaskCreate(HalTaskFn fn, const char* name, uint32_t stackBytes,
+                      uint8_t priority, int8_t core);
+HalMutex halMutexCreate();
+bool halMutexTake(HalMutex mutex, uint32_t timeoutMs);
+void halMutexGive(HalMutex mutex);
+
+// Short, non-blocking sections shared across cores (portMUX on ESP32)
+void halCriticalEnter();
+void halCriticalExit();
+
+// Fixed-rate wait; lastWake holds halTickCount() of the previous wake-up
+void halDelayUntil(uint32_t* lastWake, uint32_t periodMs);
+
+// Task notification: wake `task` / wait on the calling task's notification
+void halNotify(HalTask task);
+bool halNotifyWait(uint32_t timeoutMs);
+
+// ============================================================================
+// STORAGE (NVS namespace "modevac" on ESP32)
+// ============================================================================
+size_t halStoreGet(const char* key, void* buf, size_t len);
+bool halStorePut(const char* key, const void* buf, size_t len);
+
+// ============================================================================
+// MEMORY AND DIAGNOSTICS
+// ============================================================================
+// Large buffers: PSRAM when present (external set to true), else internal heap
+void* halAllocLarge(size_t bytes, bool* external);
+
+uint32_t halFreeHeap();
+uint32_t halMinFreeHeap();
+uint32_t halTaskStackFree(HalTask task);
+
+// Cumulative run time per task plus the total, in the same unit.
+// Returns false when the platform does not collect run-time stats.
+bool halTaskRuntime(const HalTask* tasks, uint8_t count, uint32_t* runTime, uint32_t* totalTime);
@@ -0,0 +1,225 @@
+/**
+ * MOD-EVAC-MS - ESP32 HAL
+ * Arduino core, FastLED, the MPU6050 burst reader and FreeRTOS behind hal.h.
+ */
+
+#include "hal.h"
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <Preferences.h>
+#include <esp_heap_caps.h>
+
+#include "mpu6050_i2c.h"
+
+// ============================================================================
+// HARDWARE CONFIGURATION
+// ============================================================================
+#define WATER_SENSOR_PIN    34      // Analog input for water sensor
+#define LED_DATA_PIN        5       // WS2812B data pin
+#define I2C_SDA             21      // MPU6050 SDA
+#define I2C_SCL             22      // MPU6050 SCL
+
+// ============================================================================
+// GSM MODULE CONFIGURATION (SIM800L or similar)
+// ============================================================================
+#define GSM_RX_PIN          16      // ESP32 RX <- GSM TX
+#define GSM_TX_PIN          17      // ESP32 TX -> GSM RX
+
+static CRGB leds[LED_COUNT];
+static_assert(sizeof(CRGB) == sizeof(Rgb_t), "frames are copied byte-for-byte into the FastLED buffer");
+
+// IMU ranges (same as the former Adafruit setup)
+#define IMU_ACCEL_RANGE     MPU_ACCEL_8G
+#define IMU_GYRO_RANGE      MPU_GYRO_500DPS
+static HardwareSerial GsmSerial(2);     // Use UART2
+static portMUX_TYPE halMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+uint32_t halMillis() { return millis(); }
+uint32_t halMicros() { return micros(); }
+uint32_t halTickCount() { return xTaskGetTickCount() * portTICK_PERIOD_MS; }
+void halDelayMs(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+// ============================================================================
+// SERIAL LINKS
+// ============================================================================
+class ArduinoLink : public HalLink {
+public:
+    explicit ArduinoLink(HardwareSerial& port) : _port(port) {}
+    int available() override { return _port.available(); }
+    int read() override { return _port.read(); }
+    size_t write(const uint8_t* data, size_t len) override { return _port.write(data, len); }
+private:
+    HardwareSerial& _port;
+};
+
+static ArduinoLink hostLink(Serial);
+static ArduinoLink gsmLink(GsmSerial);
+
+void halHostLinkBegin(uint32_t baud) {
+    Serial.begin(baud);
+    while (!Serial) { delay(10); }
+}
+
+void halGsmBegin(uint32_t baud) {
+    GsmSerial.begin(baud, SERIAL_8N1, GSM_RX_PIN, GSM_TX_PIN);
+}
+
+HalLink& halHostLink() { return hostLink; }
+HalLink& halGsmLink() { return gsmLink; }
+
+// ============================================================================
+// LED STRIP
+// ============================================================================
+void halLedBegin() {
+    FastLED.addLeds<WS2812B, LED_DATA_PIN, GRB>(leds, LED_COUNT);
+    FastLED.setBrightness(128);
+    FastLED.clear();
+    FastLED.show();
+}
+
+void halLedShow(const Rgb_t* frame, uint16_t count, uint8_t brightness) {
+    if (count > LED_COUNT) count = LED_COUNT;
+    for (uint16_t i = 0; i < count; i++) {
+        leds[i] = CRGB(frame[i].r, frame[i].g, frame[i].b);
+    }
+    FastLED.setBrightness(brightness);
+    FastLED.show();
+}
+
+// ============================================================================
+// SENSORS
+// ============================================================================
+bool halImuBegin() {
+    return mpuI2cBegin(I2C_SDA, I2C_SCL, MPU_I2C_CLOCK_HZ,
+                       IMU_ACCEL_RANGE, IMU_GYRO_RANGE, MPU_DLPF_21HZ) == I2C_OK;
+}
+
+I2cResult_t halImuRead(ImuRaw_t* out) {
+    uint8_t burst[MPU6050_BURST_BYTES];
+    I2cResult_t r = mpuI2cReadBurst(burst);
+    if (r == I2C_OK) mpuDecodeBurst(burst, out);
+    return r;
+}
+
+bool halImuRecover() {
+    return mpuI2cRecover() == I2C_OK;
+}
+
+ImuScale_t halImuScale() {
+    return mpuScale(IMU_ACCEL_RANGE, IMU_GYRO_RANGE);
+}
+
+void halWaterBegin() {
+    pinMode(WATER_SENSOR_PIN, INPUT);
+}
+
+int halWaterRead() {
+    return analogRead(WATER_SENSOR_PIN);
+}
+
+// ============================================================================
+// RTOS
+// ============================================================================
+HalTask halTaskCreate(HalTaskFn fn, const char* name, uint32_t stackBytes,
+                      uint8_t priority, int8_t core) {
+    TaskHandle_t handle = NULL;
+    xTaskCreatePinnedToCore(fn, name, stackBytes, NULL, priority, &handle,
+                            core < 0 ? tskNO_AFFINITY : core);
+    return (HalTask)handle;
+}
+
+HalMutex halMutexCreate() {
+    return (HalMutex)xSemaphoreCreateMutex();
+}
+
+bool halMutexTake(HalMutex mutex, uint32_t timeoutMs) {
+    return xSemaphoreTake((SemaphoreHandle_t)mutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+void halMutexGive(HalMutex mutex) {
+    xSemaphoreGive((SemaphoreHandle_t)mutex);
+}
+
+void halCriticalEnter() { portENTER_CRITICAL(&halMux); }
+void halCriticalExit() { portEXIT_CRITICAL(&halMux); }
+
+void halDelayUntil(uint32_t* lastWake, uint32_t periodMs) {
+    TickType_t wake = (TickType_t)(*lastWake / portTICK_PERIOD_MS);
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(periodMs));
+    *lastWake = wake * portTICK_PERIOD_MS;
+}
+
+void halNotify(HalTask task) {
+    if (task) xTaskNotifyGive((TaskHandle_t)task);
+}
+
+bool halNotifyWait(uint32_t timeoutMs) {
+    return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs)) > 0;
+}
+
+// ============================================================================
+// STORAGE
+// ============================================================================
+size_t halStoreGet(const char* key, void* buf, size_t len) {
+    Preferences prefs;
+    prefs.begin("modevac", true);
+    size_t n = prefs.getBytes(key, buf, len);
+    prefs.end();
+    return n;
+}
+
+bool halStorePut(const char* key, const void* buf, size_t len) {
+    Preferences prefs;
+    prefs.begin("modevac", false);
+    size_t n = prefs.putBytes(key, buf, len);
+    prefs.end();
+    return n == len;
+}
+
+// ============================================================================
+// MEMORY AND DIAGNOSTICS
+// ============================================================================
+void* halAllocLarge(size_t bytes, bool* external) {
+    void* p = NULL;
+    if (psramFound()) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    }
+    *external = (p != NULL);
+    if (!p) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+uint32_t halFreeHeap() { return ESP.getFreeHeap(); }
+uint32_t halMinFreeHeap() { return ESP.getMinFreeHeap(); }
+
+uint32_t halTaskStackFree(HalTask task) {
+    return task ? uxTaskGetStackHighWaterMark((TaskHandle_t)task) : 0;
+}
+
+bool halTaskRuntime(const HalTask* tasks, uint8_t count, uint32_t* runTime, uint32_t* totalTime) {
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    TaskStatus_t status[24];
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(status, 24, &total);
+    if (n == 0) return false;
+    for (uint8_t t = 0; t < count; t++) {
+        runTime[t] = 0;
+        for (UBaseType_t i = 0; i < n; i++) {
+            if (status[i].xHandle == (TaskHandle_t)tasks[t]) {
+                runTime[t] = status[i].ulRunTimeCounter;
+                break;
+            }
+        }
+    }
+    *totalTime = total;
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,54 @@
+/**
+ * MOD-EVAC-MS - HalLink print helpers (shared by all HAL implementations)
+ */
+
+#include "hal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+size_t HalLink::print(const char* s) {
+    return write((const uint8_t*)s, strlen(s));
+}
+
+size_t HalLink::print(int v) {
+    return print((long)v);
+}
+
+size_t HalLink::print(unsigned int v) {
+    return print((unsigned long)v);
+}
+
+size_t HalLink::print(long v) {
+    char buf[12];
+    int n = snprintf(buf, sizeof(buf), "%ld", v);
+    return write((const uint8_t*)buf, (size_t)n);
+}
+
+size_t HalLink::print(unsigned long v) {
+    char buf[12];
+    int n = snprintf(buf, sizeof(buf), "%lu", v);
+    return write((const uint8_t*)buf, (size_t)n);
+}
+
+size_t HalLink::print(double v, int digits) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    if (n < 0 || n >= (int)sizeof(buf)) return 0;
+    return write((const uint8_t*)buf, (size_t)n);
+}
+
+size_t HalLink::println(const char* s) {
+    size_t n = print(s);
+    return n + write((const uint8_t*)"\r\n", 2);
+}
+
+size_t HalLink::println(int v) {
+    size_t n = print(v);
+    return n + println();
+}
+
+size_t HalLink::println(unsigned long v) {
+    size_t n = print(v);
+    return n + println();
+}
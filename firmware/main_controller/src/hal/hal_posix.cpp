@@ -0,0 +1,334 @@
+/**
+ * MOD-EVAC-MS - POSIX HAL
+ * Runs the controller logic on Linux: tasks are std::threads, the clock is
+ * scaled so simulations run many times faster than real time, and the IMU
+ * and water ADC replay recorded samples.
+ */
+
+#include "hal_posix.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static HalPosixConfig_t config = { 1.0, 0, 1, -1, NULL, 0, false, 0, 0, 0 };
+static std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+static std::mutex criticalMutex;
+static std::mutex ledMutex;
+static uint32_t ledFrames = 0;
+
+// ============================================================================
+// CLOCK (virtual time = wall time * speed)
+// ============================================================================
+static uint64_t wallMicros() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+static void sleepVirtualMs(uint32_t ms) {
+    if (ms == 0) {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds((uint64_t)(ms * 1000.0 / config.speed)));
+}
+
+uint32_t halMillis() { return (uint32_t)(wallMicros() * config.speed / 1000.0); }
+uint32_t halMicros() { return (uint32_t)(wallMicros() * config.speed); }
+uint32_t halTickCount() { return halMillis(); }
+void halDelayMs(uint32_t ms) { sleepVirtualMs(ms); }
+
+// ============================================================================
+// SERIAL LINKS
+// ============================================================================
+class FdLink : public HalLink {
+public:
+    void attach(int inFd, int outFd) {
+        _in = inFd;
+        _out = outFd;
+        if (_in >= 0) fcntl(_in, F_SETFL, fcntl(_in, F_GETFL) | O_NONBLOCK);
+    }
+
+    int available() override {
+        std::lock_guard<std::mutex> lock(_rxMutex);
+        fill();
+        return (int)(_rxLen - _rxPos);
+    }
+
+    int read() override {
+        std::lock_guard<std::mutex> lock(_rxMutex);
+        fill();
+        return (_rxPos < _rxLen) ? _rx[_rxPos++] : -1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        if (_out < 0) return len;
+        std::lock_guard<std::mutex> lock(_txMutex);
+        size_t done = 0;
+        while (done < len) {
+            ssize_t n = ::write(_out, data + done, len - done);
+            if (n > 0) {
+                done += (size_t)n;
+            } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            } else {
+                break;  // Peer gone; drop like a disconnected UART
+            }
+        }
+        return done;
+    }
+
+private:
+    void fill() {
+        if (_rxPos < _rxLen || _in < 0) return;
+        ssize_t n = ::read(_in, _rx, sizeof(_rx));
+        _rxPos = 0;
+        _rxLen = (n > 0) ? (size_t)n : 0;
+    }
+
+    int _in = -1;
+    int _out = -1;
+    uint8_t _rx[256];
+    size_t _rxPos = 0;
+    size_t _rxLen = 0;
+    std::mutex _rxMutex;
+    std::mutex _txMutex;
+};
+
+static FdLink hostLink;
+static FdLink gsmLink;
+
+void halHostLinkBegin(uint32_t baud) { (void)baud; }
+void halGsmBegin(uint32_t baud) { (void)baud; }
+HalLink& halHostLink() { return hostLink; }
+HalLink& halGsmLink() { return gsmLink; }
+
+// ============================================================================
+// LED STRIP (frames are counted; nothing to drive)
+// ============================================================================
+void halLedBegin() {}
+
+void halLedShow(const Rgb_t* frame, uint16_t count, uint8_t brightness) {
+    (void)frame;
+    (void)count;
+    (void)brightness;
+    std::lock_guard<std::mutex> lock(ledMutex);
+    ledFrames++;
+}
+
+uint32_t halPosixLedFrames() {
+    std::lock_guard<std::mutex> lock(ledMutex);
+    return ledFrames;
+}
+
+// ============================================================================
+// SENSORS (replay)
+// ============================================================================
+static const ReplaySample_t* currentSample() {
+    if (config.sampleCount == 0) return NULL;
+
+    const ReplaySample_t* s = config.samples;
+    uint32_t t0 = s[0].tMs;
+    uint32_t span = s[config.sampleCount - 1].tMs - t0;
+    uint32_t now = halMillis() + config.replayOffsetMs;
+    if (config.loop && span > 0) now %= (span + 1);
+
+    // Binary search for the last sample at or before `now`
+    size_t lo = 0, hi = config.sampleCount;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (s[mid].tMs - t0 <= now) lo = mid; else hi = mid;
+    }
+    return &s[lo];
+}
+
+bool halPosixReplayFinished() {
+    if (config.sampleCount == 0 || config.loop) return false;
+    return halMillis() + config.replayOffsetMs > config.samples[config.sampleCount - 1].tMs - config.samples[0].tMs;
+}
+
+bool halImuBegin() { return true; }
+
+// Replay is quantised to the counts the real part would report
+static const ImuScale_t replayScale = mpuScale(MPU_ACCEL_8G, MPU_GYRO_500DPS);
+
+// Simulated unplugged sensor for exercising the recovery path
+static bool imuFaulted() {
+    uint32_t now = halMillis();
+    return now >= config.imuFaultFromMs && now < config.imuFaultUntilMs;
+}
+
+I2cResult_t halImuRead(ImuRaw_t* out) {
+    if (imuFaulted()) return I2C_ERR_NACK;
+    const ReplaySample_t* s = currentSample();
+    if (!s) {
+        // At rest, level
+        static const float level[3] = { 0.0f, 0.0f, 9.81f };
+        static const float still[3] = { 0.0f, 0.0f, 0.0f };
+        imuFromSi(level, still, replayScale, out);
+        return I2C_OK;
+    }
+    imuFromSi(s->accel, s->gyro, replayScale, out);
+    return I2C_OK;
+}
+
+bool halImuRecover() { return !imuFaulted(); }
+
+ImuScale_t halImuScale() { return replayScale; }
+
+void halWaterBegin() {}
+
+int halWaterRead() {
+    const ReplaySample_t* s = currentSample();
+    return s ? s->rawWater : 0;
+}
+
+// ============================================================================
+// RTOS (std::thread)
+// ============================================================================
+struct PosixTask {
+    std::string name;
+    pthread_t thread;
+    std::mutex notifyMutex;
+    std::condition_variable notifyCv;
+    uint32_t notifyCount = 0;
+};
+
+static thread_local PosixTask* currentTask = NULL;
+
+HalTask halTaskCreate(HalTaskFn fn, const char* name, uint32_t stackBytes,
+                      uint8_t priority, int8_t core) {
+    (void)stackBytes;
+    (void)priority;
+    (void)core;
+    PosixTask* task = new PosixTask();
+    task->name = name;
+
+    std::promise<void> started;
+    std::future<void> ready = started.get_future();
+    std::thread([task, fn, &started]() {
+        currentTask = task;
+        task->thread = pthread_self();
+        started.set_value();
+        fn(NULL);
+    }).detach();
+    ready.wait();   // The thread id must be valid before stats sample it
+    return (HalTask)task;
+}
+
+HalMutex halMutexCreate() {
+    return (HalMutex)new std::timed_mutex();
+}
+
+bool halMutexTake(HalMutex mutex, uint32_t timeoutMs) {
+    auto timeout = std::chrono::microseconds((uint64_t)(timeoutMs * 1000.0 / config.speed));
+    return ((std::timed_mutex*)mutex)->try_lock_for(timeout);
+}
+
+void halMutexGive(HalMutex mutex) {
+    ((std::timed_mutex*)mutex)->unlock();
+}
+
+void halCriticalEnter() { criticalMutex.lock(); }
+void halCriticalExit() { criticalMutex.unlock(); }
+
+void halDelayUntil(uint32_t* lastWake, uint32_t periodMs) {
+    uint32_t target = *lastWake + periodMs;
+    int32_t remaining = (int32_t)(target - halTickCount());
+    if (remaining > 0) sleepVirtualMs((uint32_t)remaining);
+    *lastWake = target;
+}
+
+void halNotify(HalTask task) {
+    PosixTask* t = (PosixTask*)task;
+    if (!t) return;
+    std::lock_guard<std::mutex> lock(t->notifyMutex);
+    t->notifyCount++;
+    t->notifyCv.notify_one();
+}
+
+bool halNotifyWait(uint32_t timeoutMs) {
+    PosixTask* t = currentTask;
+    if (!t) {
+        sleepVirtualMs(timeoutMs);
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(t->notifyMutex);
+    auto timeout = std::chrono::microseconds((uint64_t)(timeoutMs * 1000.0 / config.speed));
+    bool notified = t->notifyCv.wait_for(lock, timeout, [t]() { return t->notifyCount > 0; });
+    t->notifyCount = 0;
+    return notified;
+}
+
+// ============================================================================
+// STORAGE (in memory, lost at exit like a fresh flash)
+// ============================================================================
+static std::mutex storeMutex;
+static std::map<std::string, std::vector<uint8_t>> store;
+
+size_t halStoreGet(const char* key, void* buf, size_t len) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto it = store.find(key);
+    if (it == store.end() || it->second.size() > len) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+bool halStorePut(const char* key, const void* buf, size_t len) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    const uint8_t* p = (const uint8_t*)buf;
+    store[key].assign(p, p + len);
+    return true;
+}
+
+// ============================================================================
+// MEMORY AND DIAGNOSTICS
+// ============================================================================
+void* halAllocLarge(size_t bytes, bool* external) {
+    *external = false;
+    return malloc(bytes);
+}
+
+uint32_t halFreeHeap() { return 0; }
+uint32_t halMinFreeHeap() { return 0; }
+uint32_t halTaskStackFree(HalTask task) { (void)task; return 0; }
+
+// Thread CPU time against wall time, both in microseconds
+bool halTaskRuntime(const HalTask* tasks, uint8_t count, uint32_t* runTime, uint32_t* totalTime) {
+    for (uint8_t i = 0; i < count; i++) {
+        runTime[i] = 0;
+        PosixTask* t = (PosixTask*)tasks[i];
+        clockid_t cid;
+        struct timespec ts;
+        if (t && pthread_getcpuclockid(t->thread, &cid) == 0 && clock_gettime(cid, &ts) == 0) {
+            runTime[i] = (uint32_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+        }
+    }
+    *totalTime = (uint32_t)wallMicros();
+    return true;
+}
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+void halPosixConfigure(const HalPosixConfig_t& cfg) {
+    config = cfg;
+    if (config.speed <= 0.0) config.speed = 1.0;
+    hostLink.attach(config.hostInFd, config.hostOutFd);
+    gsmLink.attach(-1, config.gsmOutFd);
+    startTime = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,40 @@
+/**
+ * MOD-EVAC-MS - POSIX HAL configuration
+ * Native-only knobs for hal_posix.cpp: clock speed-up, where the host link
+ * and GSM UART go, and the recorded sensor data to replay.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hal.h"
+
+typedef struct {
+    uint32_t tMs;           // Capture timestamp
+    int rawWater;           // 12-bit ADC counts
+    float accel[3];         // m/s^2
+    float gyro[3];          // rad/s
+} ReplaySample_t;
+
+typedef struct {
+    double speed;                   // Virtual time runs this many times faster than wall time
+    int hostInFd;                   // Host link (stdin/stdout or a PTY)
+    int hostOutFd;
+    int gsmOutFd;                   // GSM AT traffic, -1 to discard
+    const ReplaySample_t* samples;  // Replayed by halImuRead / halWaterRead
+    size_t sampleCount;
+    bool loop;                      // Wrap around at the end of the recording
+    uint32_t replayOffsetMs;        // Start this far into the recording
+    uint32_t imuFaultFromMs;        // IMU NACKs and recovery fails in [from, until)
+    uint32_t imuFaultUntilMs;       // virtual ms; equal values disable the fault
+} HalPosixConfig_t;
+
+// Must be called before appSetup()
+void halPosixConfigure(const HalPosixConfig_t& config);
+
+// True once a non-looping replay has passed its last sample
+bool halPosixReplayFinished();
+
+uint32_t halPosixLedFrames();
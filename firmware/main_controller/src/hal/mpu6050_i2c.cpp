@@ -0,0 +1,119 @@
+/**
+ * MOD-EVAC-MS - MPU6050 I2C Transport (ESP32 / Arduino Wire)
+ */
+
+#include "mpu6050_i2c.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+
+static int busSda = -1;
+static int busScl = -1;
+static uint32_t busClockHz = MPU_I2C_CLOCK_HZ;
+static MpuAccelRange_t accelRange = MPU_ACCEL_8G;
+static MpuGyroRange_t gyroRange = MPU_GYRO_500DPS;
+static uint8_t dlpfConfig = MPU_DLPF_21HZ;
+
+// Wire.endTransmission(): 2/3 = address/data NACK, 5 = timeout
+static I2cResult_t fromWireError(uint8_t err) {
+    switch (err) {
+        case 0: return I2C_OK;
+        case 2:
+        case 3: return I2C_ERR_NACK;
+        case 5: return I2C_ERR_TIMEOUT;
+        default: return I2C_ERR_BUS;
+    }
+}
+
+static I2cResult_t writeRegister(uint8_t reg, uint8_t value) {
+    Wire.beginTransmission(MPU6050_ADDR);
+    Wire.write(reg);
+    Wire.write(value);
+    return fromWireError(Wire.endTransmission());
+}
+
+static I2cResult_t readRegisters(uint8_t reg, uint8_t* out, uint8_t len) {
+    Wire.beginTransmission(MPU6050_ADDR);
+    Wire.write(reg);
+    I2cResult_t r = fromWireError(Wire.endTransmission(false));     // Repeated start
+    if (r != I2C_OK) return r;
+    if (Wire.requestFrom((uint8_t)MPU6050_ADDR, len) != len) return I2C_ERR_BUS;
+    for (uint8_t i = 0; i < len; i++) out[i] = (uint8_t)Wire.read();
+    return I2C_OK;
+}
+
+static void startBus() {
+    Wire.begin(busSda, busScl, busClockHz);
+    Wire.setTimeOut(MPU_I2C_TIMEOUT_MS);
+}
+
+static I2cResult_t probeAndConfigure() {
+    uint8_t id = 0;
+    I2cResult_t r = readRegisters(MPU_REG_WHO_AM_I, &id, 1);
+    if (r != I2C_OK) return r;
+    if (id != MPU6050_WHO_AM_I_VALUE) return I2C_ERR_NACK;     // Something else at 0x68
+
+    MpuRegWrite_t writes[MPU_CONFIG_WRITES];
+    size_t n = mpuConfigSequence(accelRange, gyroRange, dlpfConfig, writes);
+    for (size_t i = 0; i < n; i++) {
+        r = writeRegister(writes[i].reg, writes[i].value);
+        if (r != I2C_OK) return r;
+    }
+    return I2C_OK;
+}
+
+I2cResult_t mpuI2cBegin(int sda, int scl, uint32_t clockHz,
+                        MpuAccelRange_t accel, MpuGyroRange_t gyro, uint8_t dlpf) {
+    busSda = sda;
+    busScl = scl;
+    busClockHz = clockHz;
+    accelRange = accel;
+    gyroRange = gyro;
+    dlpfConfig = dlpf;
+
+    startBus();
+    I2cResult_t r = probeAndConfigure();
+    if (r == I2C_OK) delay(10);     // PLL settle after wake (boot only)
+    return r;
+}
+
+void mpuI2cSetClock(uint32_t clockHz) {
+    busClockHz = clockHz;
+    Wire.setClock(clockHz);
+}
+
+I2cResult_t mpuI2cReadBurst(uint8_t* out) {
+    return readRegisters(MPU_REG_ACCEL_XOUT_H, out, MPU6050_BURST_BYTES);
+}
+
+I2cResult_t mpuI2cRecover() {
+    Wire.end();
+
+    // A slave reset mid-byte can hold SDA low waiting for clocks; at most
+    // nine pulses walk it out of the byte. ~5 us half period (100 kHz).
+    pinMode(busSda, INPUT_PULLUP);
+    pinMode(busScl, OUTPUT_OPEN_DRAIN);
+    digitalWrite(busScl, HIGH);
+    delayMicroseconds(5);
+    for (int i = 0; i < 9 && digitalRead(busSda) == LOW; i++) {
+        digitalWrite(busScl, LOW);
+        delayMicroseconds(5);
+        digitalWrite(busScl, HIGH);
+        delayMicroseconds(5);
+    }
+
+    // STOP condition: SDA rises while SCL is high
+    pinMode(busSda, OUTPUT_OPEN_DRAIN);
+    digitalWrite(busSda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(busScl, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(busSda, HIGH);
+    delayMicroseconds(5);
+    pinMode(busSda, INPUT_PULLUP);
+    bool released = digitalRead(busSda) == HIGH;
+
+    startBus();
+    if (!released) return I2C_ERR_TIMEOUT;     // Still held low: try again after backoff
+    return probeAndConfigure();
+}
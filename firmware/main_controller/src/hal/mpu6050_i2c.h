@@ -0,0 +1,37 @@
+/**
+ * MOD-EVAC-MS - MPU6050 I2C Transport (ESP32 / Arduino Wire)
+ * One register-pointer write plus one 14-byte read per sample, in fast
+ * mode. Replaces Adafruit_MPU6050::getEvent, which read at 100 kHz and
+ * scaled every field through Adafruit_Sensor.
+ *
+ * Every transaction is bounded by MPU_I2C_TIMEOUT_MS and reports why it
+ * failed, and mpuI2cRecover() frees a stuck bus and reconfigures the part
+ * so the sensor task can hot-reconnect without a reboot.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../i2c_health.h"
+#include "../mpu6050.h"
+
+// The MPU6050 datasheet tops out at 400 kHz. 1 MHz usually works on
+// short traces and is what the bench compares against, but is out of spec.
+#define MPU_I2C_CLOCK_HZ        400000
+#define MPU_I2C_TIMEOUT_MS      2       // A 14-byte burst takes ~0.4 ms at 400 kHz
+
+// Starts the bus, probes WHO_AM_I and applies the configuration. The
+// settings are kept for mpuI2cRecover().
+I2cResult_t mpuI2cBegin(int sda, int scl, uint32_t clockHz,
+                        MpuAccelRange_t accel, MpuGyroRange_t gyro, uint8_t dlpf);
+
+// Changes the bus clock without re-probing (benchmarks)
+void mpuI2cSetClock(uint32_t clockHz);
+
+// Reads ACCEL_XOUT_H..GYRO_ZOUT_L into `out` (MPU6050_BURST_BYTES)
+I2cResult_t mpuI2cReadBurst(uint8_t* out);
+
+// Bus clear (up to 9 SCL pulses until SDA is released, then a STOP),
+// bus restart, re-probe and reconfigure. Well under one sample period.
+I2cResult_t mpuI2cRecover();
@@ -0,0 +1,102 @@
+/**
+ * MOD-EVAC-MS - I2C Device Health
+ * Per-device error accounting and the offline / re-probe schedule.
+ *
+ * The sensor task reports every transaction result. After
+ * I2C_FAIL_THRESHOLD consecutive failures the device is declared offline
+ * and reads stop; from then on recoveryDue() hands out one bounded
+ * recovery attempt (bus clear + re-probe + reconfigure) per backoff
+ * window, doubling from I2C_BACKOFF_MIN_MS to I2C_BACKOFF_MAX_MS, so a
+ * dead sensor costs the 50 Hz loop a few milliseconds every few seconds
+ * instead of a blocked read every period. Pure C++, no Arduino dependency;
+ * the caller serialises access.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define I2C_FAIL_THRESHOLD      3       // Consecutive failures before going offline
+#define I2C_BACKOFF_MIN_MS      100
+#define I2C_BACKOFF_MAX_MS      5000
+
+typedef enum {
+    I2C_OK = 0,
+    I2C_ERR_NACK,           // Address or data not acknowledged (absent / wrong part)
+    I2C_ERR_TIMEOUT,        // Bus held or clock stretched past the transaction bound
+    I2C_ERR_BUS             // Arbitration lost, short read, anything else
+} I2cResult_t;
+
+class I2cDeviceHealth {
+public:
+    // Boot probe result; a failed probe starts in the recovery schedule
+    void begin(bool present, uint32_t nowMs) {
+        _online = present;
+        _consecutive = 0;
+        _backoffMs = I2C_BACKOFF_MIN_MS;
+        _nextAttemptMs = nowMs + _backoffMs;
+    }
+
+    // One transaction result while online
+    void record(I2cResult_t result, uint32_t nowMs) {
+        reads++;
+        if (result == I2C_OK) {
+            _consecutive = 0;
+            return;
+        }
+
+        if (result == I2C_ERR_NACK) nacks++;
+        else if (result == I2C_ERR_TIMEOUT) timeouts++;
+        else busErrors++;
+        lastErrorMs = nowMs;
+
+        if (_online && ++_consecutive >= I2C_FAIL_THRESHOLD) {
+            _online = false;
+            _lost = true;
+            _backoffMs = I2C_BACKOFF_MIN_MS;
+            _nextAttemptMs = nowMs + _backoffMs;
+        }
+    }
+
+    // True when an offline device is due for a recovery attempt
+    bool recoveryDue(uint32_t nowMs) const {
+        return !_online && (int32_t)(nowMs - _nextAttemptMs) >= 0;
+    }
+
+    void recordRecovery(bool ok, uint32_t nowMs) {
+        probes++;
+        if (ok) {
+            _online = true;
+            _consecutive = 0;
+            _restored = true;
+            recoveries++;
+            return;
+        }
+        _backoffMs = (_backoffMs * 2 > I2C_BACKOFF_MAX_MS) ? I2C_BACKOFF_MAX_MS : _backoffMs * 2;
+        _nextAttemptMs = nowMs + _backoffMs;
+    }
+
+    // One-shot notifications for the serial task
+    bool takeLost() { bool v = _lost; _lost = false; return v; }
+    bool takeRestored() { bool v = _restored; _restored = false; return v; }
+
+    bool online() const { return _online; }
+    uint32_t errors() const { return nacks + timeouts + busErrors; }
+    uint32_t backoffMs() const { return _backoffMs; }
+
+    uint32_t reads = 0;
+    uint32_t nacks = 0;
+    uint32_t timeouts = 0;
+    uint32_t busErrors = 0;
+    uint32_t probes = 0;
+    uint32_t recoveries = 0;
+    uint32_t lastErrorMs = 0;
+
+private:
+    bool _online = false;
+    bool _lost = false;
+    bool _restored = false;
+    uint8_t _consecutive = 0;
+    uint32_t _backoffMs = I2C_BACKOFF_MIN_MS;
+    uint32_t _nextAttemptMs = 0;
+};
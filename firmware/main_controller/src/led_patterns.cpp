@@ -0,0 +1,48 @@
+/**
+ * MOD-EVAC-MS - LED Frame Composition
+ */
+
+#include "led_patterns.h"
+
+#include <string.h>
+
+void fillZone(Rgb_t* leds, int zone, Rgb_t color) {
+    if (zone < 0 || zone >= NUM_ZONES) return;
+    for (int i = LED_ZONES[zone][0]; i <= LED_ZONES[zone][1]; i++) {
+        leds[i] = color;
+    }
+}
+
+void fillAllZones(Rgb_t* leds, Rgb_t color) {
+    for (int z = 0; z < NUM_ZONES; z++) {
+        fillZone(leds, z, color);
+    }
+}
+
+void composeEvacuationFrame(Rgb_t* leds, int exitZone, uint8_t phase) {
+    const Rgb_t head = {0, 128, 0};     // CRGB::Green
+    const Rgb_t trail1 = {0, 100, 0};
+    const Rgb_t trail2 = {0, 50, 0};
+
+    memset(leds, 0, LED_COUNT * sizeof(Rgb_t));
+
+    // Chase pattern: light up 3 LEDs moving toward exit
+    for (int z = 0; z < NUM_ZONES; z++) {
+        int start = LED_ZONES[z][0];
+        int end = LED_ZONES[z][1];
+        int zoneLen = end - start + 1;
+
+        int pos = (phase % zoneLen);
+        if (z < exitZone) {
+            // Chase forward toward exit
+            leds[start + pos] = head;
+            if (pos > 0) leds[start + pos - 1] = trail1;
+            if (pos > 1) leds[start + pos - 2] = trail2;
+        } else if (z == exitZone) {
+            // Exit zone solid green
+            for (int i = start; i <= end; i++) {
+                leds[i] = head;
+            }
+        }
+    }
+}
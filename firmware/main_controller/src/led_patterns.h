@@ -0,0 +1,42 @@
+/**
+ * MOD-EVAC-MS - LED Frame Composition
+ * Zone fills and the evacuation chase, composed into a plain RGB buffer.
+ *
+ * Rgb_t has the same 3-byte layout as FastLED's CRGB; the HAL copies the
+ * composed frame into the strip buffer. No FastLED dependency, builds natively.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================================
+// LED ZONE CONFIGURATION (Nested array for evacuation control)
+// Each zone: {start_led, end_led}
+// ============================================================================
+#define LED_COUNT           60      // Total LEDs in strip
+#define NUM_ZONES           4
+#define EXIT_ZONE           3       // Evacuation chase runs toward this zone
+
+static const uint8_t LED_ZONES[NUM_ZONES][2] = {
+    {0, 14},    // Zone 0: Entrance area
+    {15, 29},   // Zone 1: Hallway section A
+    {30, 44},   // Zone 2: Hallway section B
+    {45, 59}    // Zone 3: Exit area
+};
+
+typedef struct {
+    uint8_t r, g, b;
+} Rgb_t;
+
+// Alert colours (CRGB::Green is 0,128,0)
+static const Rgb_t RGB_GREEN = { 0, 128, 0 };
+static const Rgb_t RGB_AMBER = { 255, 150, 0 };
+static const Rgb_t RGB_BLUE  = { 0, 0, 255 };
+static const Rgb_t RGB_RED   = { 255, 0, 0 };
+
+void fillZone(Rgb_t* leds, int zone, Rgb_t color);
+void fillAllZones(Rgb_t* leds, Rgb_t color);
+
+// One frame of the chase toward exitZone. Clears the buffer first.
+void composeEvacuationFrame(Rgb_t* leds, int exitZone, uint8_t phase);
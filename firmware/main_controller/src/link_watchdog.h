@@ -0,0 +1,75 @@
+/**
+ * MOD-EVAC-MS - Host Link Watchdog
+ * Tracks the last valid host command and declares a failover when the
+ * backend goes silent for longer than the configured window.
+ *
+ * feed() is called for every parsed command, poll() once per sensor sample,
+ * so failover is detected within timeout + one sample period. Both sides
+ * must be called under the same lock. Pure C++, no Arduino dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define LINK_TIMEOUT_DEFAULT_MS 15000   // Three missed backend pings (5 s)
+#define LINK_TIMEOUT_MIN_MS     2000
+#define LINK_TIMEOUT_MAX_MS     600000
+
+class LinkWatchdog {
+public:
+    void begin(uint32_t timeoutMs, uint32_t nowMs) {
+        setTimeout(timeoutMs);
+        _lastFeedMs = nowMs;
+        _failover = false;
+    }
+
+    void setTimeout(uint32_t ms) {
+        if (ms < LINK_TIMEOUT_MIN_MS) ms = LINK_TIMEOUT_MIN_MS;
+        if (ms > LINK_TIMEOUT_MAX_MS) ms = LINK_TIMEOUT_MAX_MS;
+        _timeoutMs = ms;
+    }
+
+    // Valid host traffic. Ends a failover if one is in progress.
+    void feed(uint32_t nowMs) {
+        _lastFeedMs = nowMs;
+        if (_failover) {
+            _failover = false;
+            _lastOutageMs = nowMs - _failoverAtMs;
+            _restored = true;
+        }
+    }
+
+    // Returns true on the sample where the failover is declared.
+    bool poll(uint32_t nowMs) {
+        if (_failover || (nowMs - _lastFeedMs) < _timeoutMs) return false;
+        _failover = true;
+        _failoverAtMs = nowMs;
+        _detectMs = nowMs - _lastFeedMs;
+        _failovers++;
+        _lost = true;
+        return true;
+    }
+
+    // One-shot notifications for the serial task
+    bool takeLost() { bool v = _lost; _lost = false; return v; }
+    bool takeRestored() { bool v = _restored; _restored = false; return v; }
+
+    bool failover() const { return _failover; }
+    uint32_t timeoutMs() const { return _timeoutMs; }
+    uint32_t lastFeedMs() const { return _lastFeedMs; }
+    uint32_t detectMs() const { return _detectMs; }         // Silence before failover was declared
+    uint32_t lastOutageMs() const { return _lastOutageMs; } // Failover duration, set on restore
+    uint32_t failovers() const { return _failovers; }
+
+private:
+    uint32_t _timeoutMs = LINK_TIMEOUT_DEFAULT_MS;
+    uint32_t _lastFeedMs = 0;
+    uint32_t _failoverAtMs = 0;
+    uint32_t _detectMs = 0;
+    uint32_t _lastOutageMs = 0;
+    uint32_t _failovers = 0;
+    bool _failover = false;
+    bool _lost = false;
+    bool _restored = false;
+};
@@ -0,0 +1,62 @@
+/**
+ * MOD-EVAC-MS - MPU6050 Register Map and Sample Decoding
+ */
+
+#include "mpu6050.h"
+
+#include <math.h>
+
+#define GRAVITY_MS2         9.80665f
+#define DEG_TO_RAD_F        0.017453293f
+
+size_t mpuConfigSequence(MpuAccelRange_t accel, MpuGyroRange_t gyro, uint8_t dlpf,
+                         MpuRegWrite_t* out) {
+    size_t n = 0;
+    out[n++] = { MPU_REG_PWR_MGMT_1, 0x01 };           // Wake, PLL on gyro X
+    out[n++] = { MPU_REG_SMPLRT_DIV, 0x00 };           // 1 kHz internal rate with DLPF on
+    out[n++] = { MPU_REG_CONFIG, (uint8_t)(dlpf & 0x07) };
+    out[n++] = { MPU_REG_GYRO_CONFIG, (uint8_t)(gyro << 3) };
+    out[n++] = { MPU_REG_ACCEL_CONFIG, (uint8_t)(accel << 3) };
+    return n;
+}
+
+ImuScale_t mpuScale(MpuAccelRange_t accel, MpuGyroRange_t gyro) {
+    // Datasheet sensitivities: 16384 LSB/g and 131 LSB/(deg/s) at the
+    // smallest range, halving with each range step
+    ImuScale_t s;
+    s.accel = GRAVITY_MS2 / (float)(16384 >> accel);
+    s.gyro = DEG_TO_RAD_F / (131.0f / (float)(1 << gyro));
+    return s;
+}
+
+void mpuDecodeBurst(const uint8_t* buf, ImuRaw_t* out) {
+    out->accel[0] = (int16_t)((buf[0] << 8) | buf[1]);
+    out->accel[1] = (int16_t)((buf[2] << 8) | buf[3]);
+    out->accel[2] = (int16_t)((buf[4] << 8) | buf[5]);
+    out->temp     = (int16_t)((buf[6] << 8) | buf[7]);
+    out->gyro[0]  = (int16_t)((buf[8] << 8) | buf[9]);
+    out->gyro[1]  = (int16_t)((buf[10] << 8) | buf[11]);
+    out->gyro[2]  = (int16_t)((buf[12] << 8) | buf[13]);
+}
+
+static int16_t toCounts(float v, float scale) {
+    float c = v / scale;
+    if (c > 32767.0f) return 32767;
+    if (c < -32768.0f) return -32768;
+    return (int16_t)lrintf(c);
+}
+
+void imuFromSi(const float accel[3], const float gyro[3], const ImuScale_t& scale, ImuRaw_t* out) {
+    for (int k = 0; k < 3; k++) {
+        out->accel[k] = toCounts(accel[k], scale.accel);
+        out->gyro[k] = toCounts(gyro[k], scale.gyro);
+    }
+    out->temp = 0;
+}
+
+void imuToSi(const ImuRaw_t& raw, const ImuScale_t& scale, float accel[3], float gyro[3]) {
+    for (int k = 0; k < 3; k++) {
+        accel[k] = raw.accel[k] * scale.accel;
+        gyro[k] = raw.gyro[k] * scale.gyro;
+    }
+}
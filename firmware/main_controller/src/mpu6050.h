@@ -0,0 +1,80 @@
+/**
+ * MOD-EVAC-MS - MPU6050 Register Map and Sample Decoding
+ * The bus-independent half of the lean IMU driver: configuration writes,
+ * 14-byte burst decoding (ACCEL_XOUT_H..GYRO_ZOUT_L) and scale factors.
+ *
+ * Samples stay as int16 counts; scaling to SI is done by whoever needs it
+ * (imuToSi), so the read path itself is a single I2C transaction with no
+ * float work. The I2C transport lives in hal/mpu6050_i2c.cpp.
+ * Pure C++, no Arduino dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MPU6050_ADDR            0x68
+#define MPU6050_WHO_AM_I_VALUE  0x68
+#define MPU6050_BURST_BYTES     14      // Accel XYZ, temperature, gyro XYZ
+
+// ============================================================================
+// REGISTERS
+// ============================================================================
+#define MPU_REG_SMPLRT_DIV      0x19
+#define MPU_REG_CONFIG          0x1A    // DLPF_CFG
+#define MPU_REG_GYRO_CONFIG     0x1B
+#define MPU_REG_ACCEL_CONFIG    0x1C
+#define MPU_REG_ACCEL_XOUT_H    0x3B    // Start of the burst
+#define MPU_REG_PWR_MGMT_1      0x6B
+#define MPU_REG_WHO_AM_I        0x75
+
+typedef enum {
+    MPU_ACCEL_2G = 0,
+    MPU_ACCEL_4G,
+    MPU_ACCEL_8G,
+    MPU_ACCEL_16G
+} MpuAccelRange_t;
+
+typedef enum {
+    MPU_GYRO_250DPS = 0,
+    MPU_GYRO_500DPS,
+    MPU_GYRO_1000DPS,
+    MPU_GYRO_2000DPS
+} MpuGyroRange_t;
+
+#define MPU_DLPF_21HZ           4       // Same filter the Adafruit setup used
+
+typedef struct {
+    int16_t accel[3];       // Counts, see ImuScale_t
+    int16_t temp;
+    int16_t gyro[3];
+} ImuRaw_t;
+
+typedef struct {
+    float accel;            // m/s^2 per count
+    float gyro;             // rad/s per count
+} ImuScale_t;
+
+typedef struct {
+    uint8_t reg;
+    uint8_t value;
+} MpuRegWrite_t;
+
+#define MPU_CONFIG_WRITES       5
+
+// Register writes that wake the part and apply ranges / filter, in order.
+// `out` must hold MPU_CONFIG_WRITES entries.
+size_t mpuConfigSequence(MpuAccelRange_t accel, MpuGyroRange_t gyro, uint8_t dlpf,
+                         MpuRegWrite_t* out);
+
+ImuScale_t mpuScale(MpuAccelRange_t accel, MpuGyroRange_t gyro);
+
+// Big-endian burst from ACCEL_XOUT_H to counts
+void mpuDecodeBurst(const uint8_t* buf, ImuRaw_t* out);
+
+// Counts to m/s^2 and rad/s
+void imuToSi(const ImuRaw_t& raw, const ImuScale_t& scale, float accel[3], float gyro[3]);
+
+// m/s^2 and rad/s to the saturated counts the part would report (replay)
+void imuFromSi(const float accel[3], const float gyro[3], const ImuScale_t& scale, ImuRaw_t* out);
@@ -0,0 +1,164 @@
+/**
+ * MOD-EVAC-MS - On-device Hazard Rules Engine
+ */
+
+#include "rules_engine.h"
+
+#include <math.h>
+#include <string.h>
+
+static_assert(sizeof(HazardRule_t) == 16, "NVS blob layout assumes 16-byte rules");
+
+const char* const SENSOR_CHANNEL_NAMES[NUM_CHANNELS] = {
+    "water", "accel_x", "accel_y", "accel_z", "gyro_x", "gyro_y", "gyro_z", "gyro_xy", "accel_mag",
+    "vib_quake", "pga", "mmi", "water_rise", "water_eta"
+};
+
+// AlertState_t levels (app.cpp)
+static const uint8_t LEVEL_CALLING = 1;
+static const uint8_t LEVEL_DANGER = 3;
+
+const HazardRule_t DEFAULT_HAZARD_RULES[] = {
+    // channel,   op,         alert,          rsv, threshold, hysteresis, holdMs
+    { CH_WATER,   RULE_ABOVE, LEVEL_DANGER,   0,   70.0f,     5.0f,       500  },
+    { CH_WATER,   RULE_ABOVE, LEVEL_CALLING,  0,   40.0f,     5.0f,       1000 },
+    { CH_VIB_QUAKE, RULE_ABOVE, LEVEL_CALLING, 0,  0.1f,      0.03f,      0    },
+    { CH_MMI,     RULE_ABOVE, LEVEL_DANGER,   0,   5.5f,      0.5f,       2000 },
+    { CH_WATER_ETA, RULE_BELOW, LEVEL_CALLING, 0,  600.0f,    60.0f,      5000 },
+};
+const uint8_t DEFAULT_HAZARD_RULE_COUNT = sizeof(DEFAULT_HAZARD_RULES) / sizeof(DEFAULT_HAZARD_RULES[0]);
+
+bool RulesEngine::load(const HazardRule_t* rules, uint8_t count) {
+    if (count > RULES_MAX) return false;
+    for (uint8_t i = 0; i < count; i++) {
+        if (rules[i].channel >= NUM_CHANNELS || rules[i].op > RULE_BELOW
+            || rules[i].alert > RULE_ALERT_MAX) {
+            return false;
+        }
+    }
+
+    if (count > 0) memcpy(_rules, rules, count * sizeof(HazardRule_t));
+    _count = count;
+    memset(_active, 0, sizeof(_active));
+    memset(_pending, 0, sizeof(_pending));
+    _firedMask = 0;
+    _clearedMask = 0;
+    compile();
+    return true;
+}
+
+void RulesEngine::setScales(const float* unitsPerLsb) {
+    for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+        _scale[c] = (unitsPerLsb[c] > 0.0f) ? unitsPerLsb[c] : 1.0f;
+    }
+    compile();
+}
+
+bool RulesEngine::highestThreshold(uint8_t channel, uint8_t op, float* threshold) const {
+    bool found = false;
+    uint8_t best = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        const HazardRule_t& r = _rules[i];
+        if (r.channel != channel || r.op != op) continue;
+        if (!found || r.alert > best) {
+            best = r.alert;
+            *threshold = r.threshold;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static int32_t clampBound(float v) {
+    if (v > 2147483520.0f) return INT32_MAX;
+    if (v < -2147483520.0f) return INT32_MIN;
+    return (int32_t)v;
+}
+
+// Integer v satisfies v * scale > t exactly when v > floor(t / scale), and
+// v * scale < t when v < ceil(t / scale)
+void RulesEngine::compile() {
+    for (uint8_t i = 0; i < _count; i++) {
+        const HazardRule_t& r = _rules[i];
+        float scale = _scale[r.channel];
+        if (r.op == RULE_ABOVE) {
+            _fire[i] = clampBound(floorf(r.threshold / scale));
+            _clear[i] = clampBound(ceilf((r.threshold - r.hysteresis) / scale));
+        } else {
+            _fire[i] = clampBound(ceilf(r.threshold / scale));
+            _clear[i] = clampBound(floorf((r.threshold + r.hysteresis) / scale));
+        }
+    }
+}
+
+uint8_t RulesEngine::evaluate(const int32_t* channels, uint32_t nowMs) {
+    uint8_t level = 0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        const HazardRule_t& r = _rules[i];
+        int32_t v = channels[r.channel];
+
+        bool over, clear;
+        if (r.op == RULE_ABOVE) {
+            over = v > _fire[i];
+            clear = v < _clear[i];
+        } else {
+            over = v < _fire[i];
+            clear = v > _clear[i];
+        }
+
+        if (!_active[i]) {
+            if (!over) {
+                _pending[i] = false;
+            } else if (!_pending[i]) {
+                _pending[i] = true;
+                _pendingSince[i] = nowMs;
+            }
+            if (_pending[i] && (nowMs - _pendingSince[i]) >= r.holdMs) {
+                _active[i] = true;
+                _pending[i] = false;
+                _firedAt[i] = nowMs;
+                _firedValue[i] = v;
+                _firedMask |= (1UL << i);
+            }
+        } else if (clear) {
+            _active[i] = false;
+            _clearedMask |= (1UL << i);
+        }
+
+        if (_active[i] && r.alert > level) level = r.alert;
+    }
+
+    return level;
+}
+
+uint32_t RulesEngine::takeFired() {
+    uint32_t m = _firedMask;
+    _firedMask = 0;
+    return m;
+}
+
+uint32_t RulesEngine::takeCleared() {
+    uint32_t m = _clearedMask;
+    _clearedMask = 0;
+    return m;
+}
+
+size_t RulesEngine::serialize(uint8_t* out, size_t cap) const {
+    size_t need = 2 + (size_t)_count * sizeof(HazardRule_t);
+    if (cap < need) return 0;
+    out[0] = RULES_BLOB_VERSION;
+    out[1] = _count;
+    if (_count > 0) memcpy(out + 2, _rules, _count * sizeof(HazardRule_t));
+    return need;
+}
+
+bool RulesEngine::deserialize(const uint8_t* in, size_t len) {
+    if (len < 2 || in[0] != RULES_BLOB_VERSION) return false;
+    uint8_t count = in[1];
+    if (count > RULES_MAX || len < 2 + (size_t)count * sizeof(HazardRule_t)) return false;
+
+    HazardRule_t rules[RULES_MAX];
+    if (count > 0) memcpy(rules, in + 2, count * sizeof(HazardRule_t));
+    return load(rules, count);
+}
@@ -0,0 +1,127 @@
+/**
+ * MOD-EVAC-MS - On-device Hazard Rules Engine
+ * Threshold / hysteresis / hold-time rules evaluated on every sensor sample.
+ *
+ * Rules are a flat table uploaded by the backend (rules_set) and persisted
+ * in NVS, so the controller can raise an alert within one sample period
+ * even when the host is slow or gone. Pure C++, no Arduino dependency.
+ *
+ * Rules are written in engineering units; samples arrive as integer
+ * channel LSBs (sensor_convert.h). load() / setScales() compile each
+ * threshold into integer fire / clear bounds once, so evaluate() is
+ * integer compares only.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define RULES_MAX           8
+#define RULES_BLOB_VERSION  1
+#define RULES_BLOB_BYTES    (2 + RULES_MAX * 16)
+#define RULE_ALERT_MAX      4       // ALERT_EVACUATE (app.cpp)
+
+// ============================================================================
+// SENSOR CHANNELS (index into the array passed to evaluate)
+// Rule units / sample LSBs
+// ============================================================================
+typedef enum {
+    CH_WATER = 0,           // Water level % / Q15 of ADC full scale
+    CH_ACCEL_X,             // m/s^2 / accel counts
+    CH_ACCEL_Y,
+    CH_ACCEL_Z,
+    CH_GYRO_X,              // rad/s / gyro counts
+    CH_GYRO_Y,
+    CH_GYRO_Z,
+    CH_GYRO_XY,             // |gx| + |gy|, same metric as control_worker tilt check
+    CH_ACCEL_MAG,           // |a| including gravity
+    CH_VIB_QUAKE,           // Quake-band (1-10 Hz) RMS, 0 when impulsive / accel counts (vibration_fft.h)
+    CH_PGA,                 // Peak ground acceleration, sliding window / accel counts (ground_motion.h)
+    CH_MMI,                 // Instrumental intensity (Modified Mercalli) of the last 1 s bucket / tenths
+    CH_WATER_RISE,          // Water rate of rise %/min / Q15 of full scale per minute (water_trend.h)
+    CH_WATER_ETA,           // Seconds until water reaches the DANGER rule threshold / seconds
+    NUM_CHANNELS
+} SensorChannel_t;
+
+// Host-facing channel names (aggregate records), indexed by SensorChannel_t
+extern const char* const SENSOR_CHANNEL_NAMES[NUM_CHANNELS];
+
+typedef enum {
+    RULE_ABOVE = 0,         // Fires when value > threshold
+    RULE_BELOW              // Fires when value < threshold
+} RuleOp_t;
+
+typedef struct {
+    uint8_t channel;        // SensorChannel_t
+    uint8_t op;             // RuleOp_t
+    uint8_t alert;          // Alert level requested while active (AlertState_t, <= RULE_ALERT_MAX)
+    uint8_t reserved;
+    float threshold;
+    float hysteresis;       // Clear only once back past threshold -/+ hysteresis
+    uint32_t holdMs;        // Condition must persist this long before firing
+} HazardRule_t;
+
+// Factory rules used when NVS holds none. Thresholds mirror
+// backend/control_worker.py; alert values are the firmware's AlertState_t.
+extern const HazardRule_t DEFAULT_HAZARD_RULES[];
+extern const uint8_t DEFAULT_HAZARD_RULE_COUNT;
+
+class RulesEngine {
+public:
+    RulesEngine() {
+        for (uint8_t c = 0; c < NUM_CHANNELS; c++) _scale[c] = 1.0f;
+    }
+
+    // Rejects the whole table if any rule has an unknown channel, op or
+    // alert level; every path (rules_set, NVS, defaults) goes through here
+    bool load(const HazardRule_t* rules, uint8_t count);
+    void clear() { load(nullptr, 0); }
+
+    // Engineering units per channel LSB (NUM_CHANNELS entries, default 1.0).
+    // Recompiles the loaded rules.
+    void setScales(const float* unitsPerLsb);
+
+    // Runs every rule against one sample of channel LSBs. Returns the
+    // highest alert level requested by an active rule (0 when none).
+    uint8_t evaluate(const int32_t* channels, uint32_t nowMs);
+
+    // Rules that fired / cleared since the last call (bit i = rule i)
+    uint32_t takeFired();
+    uint32_t takeCleared();
+
+    uint8_t count() const { return _count; }
+    const HazardRule_t& rule(uint8_t i) const { return _rules[i]; }
+    bool isActive(uint8_t i) const { return _active[i]; }
+    float firedValue(uint8_t i) const { return _firedValue[i] * _scale[_rules[i].channel]; }
+    uint32_t firedAtMs(uint8_t i) const { return _firedAt[i]; }
+
+    // Threshold of the highest-alert rule with this channel and op (the
+    // level the water trend predicts against); false when there is none
+    bool highestThreshold(uint8_t channel, uint8_t op, float* threshold) const;
+
+    // Compact NVS blob: [version][count][16 bytes per rule]
+    size_t serialize(uint8_t* out, size_t cap) const;
+    bool deserialize(const uint8_t* in, size_t len);
+
+private:
+    void compile();
+
+    HazardRule_t _rules[RULES_MAX];
+    uint8_t _count = 0;
+    float _scale[NUM_CHANNELS];
+
+    // Compiled bounds in channel LSBs: ABOVE fires on v > fire, clears on
+    // v < clear; BELOW fires on v < fire, clears on v > clear
+    int32_t _fire[RULES_MAX] = {};
+    int32_t _clear[RULES_MAX] = {};
+
+    bool _active[RULES_MAX] = {};
+    bool _pending[RULES_MAX] = {};
+    uint32_t _pendingSince[RULES_MAX] = {};
+    uint32_t _firedAt[RULES_MAX] = {};
+    int32_t _firedValue[RULES_MAX] = {};
+
+    uint32_t _firedMask = 0;
+    uint32_t _clearedMask = 0;
+};
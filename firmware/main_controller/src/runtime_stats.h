@@ -0,0 +1,86 @@
+/**
+ * MOD-EVAC-MS - Runtime Statistics
+ * Cheap counters for loop timing, kept on in production.
+ *
+ * PeriodMonitor: wake-to-wake interval of a periodic task, bucketed into a
+ *                lateness histogram with deadline-miss counting.
+ * DurationMonitor: count / mean / max of a timed section (LED frame, etc).
+ *
+ * Pure C++, no Arduino dependency; the caller supplies micros() and the lock.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Lateness histogram bucket upper edges (us). Last bucket is open-ended.
+#define JITTER_BINS 6
+static const uint32_t JITTER_BIN_EDGES_US[JITTER_BINS - 1] = { 100, 500, 1000, 2000, 5000 };
+
+class PeriodMonitor {
+public:
+    void begin(uint32_t periodUs, uint32_t missToleranceUs) {
+        _periodUs = periodUs;
+        _toleranceUs = missToleranceUs;
+        _lastUs = 0;
+        _started = false;
+        reset();
+    }
+
+    // Call once per wake-up with the current micros()
+    void tick(uint32_t nowUs) {
+        if (_started) {
+            uint32_t interval = nowUs - _lastUs;
+            uint32_t dev = (interval > _periodUs) ? interval - _periodUs : _periodUs - interval;
+
+            uint8_t bin = 0;
+            while (bin < JITTER_BINS - 1 && dev >= JITTER_BIN_EDGES_US[bin]) bin++;
+            hist[bin]++;
+
+            if (interval > _periodUs + _toleranceUs) misses++;
+            if (dev > maxDevUs) maxDevUs = dev;
+            samples++;
+        }
+        _lastUs = nowUs;
+        _started = true;
+    }
+
+    void reset() {
+        for (uint8_t i = 0; i < JITTER_BINS; i++) hist[i] = 0;
+        misses = 0;
+        maxDevUs = 0;
+        samples = 0;
+    }
+
+    uint32_t hist[JITTER_BINS];
+    uint32_t misses;
+    uint32_t maxDevUs;
+    uint32_t samples;
+
+private:
+    uint32_t _periodUs = 0;
+    uint32_t _toleranceUs = 0;
+    uint32_t _lastUs = 0;
+    bool _started = false;
+};
+
+class DurationMonitor {
+public:
+    void add(uint32_t us) {
+        count++;
+        sumUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    uint32_t meanUs() const { return count ? (uint32_t)(sumUs / count) : 0; }
+
+    void reset() {
+        count = 0;
+        sumUs = 0;
+        maxUs = 0;
+    }
+
+    uint32_t count = 0;
+    uint64_t sumUs = 0;
+    uint32_t maxUs = 0;
+};
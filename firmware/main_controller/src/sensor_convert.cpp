@@ -0,0 +1,129 @@
+/**
+ * MOD-EVAC-MS - Sensor Conversion
+ */
+
+#include "sensor_convert.h"
+
+#include <math.h>
+
+// Q16 factor for raw * 32767 / 4095, truncated so 4095 lands on Q15_ONE
+#define WATER_Q15_PER_COUNT_Q16 ((uint32_t)(((uint64_t)Q15_ONE << 16) / WATER_ADC_MAX))
+
+// ============================================================================
+// FIXED-POINT PATH
+// ============================================================================
+
+const DerivedLevels_t DERIVED_LEVELS_IDLE = { 0, 0, 10, 0, WATER_TREND_ETA_NONE_S };
+
+q15_t waterQ15FromRaw(int raw) {
+    if (raw <= 0) return 0;
+    if (raw >= WATER_ADC_MAX) return Q15_ONE;
+    return (q15_t)(((uint32_t)raw * WATER_Q15_PER_COUNT_Q16) >> 16);
+}
+
+RecorderScaleQ_t recorderScaleQ(const ImuScale_t& imu) {
+    RecorderScaleQ_t s;
+    s.accelCms = toQ16(imu.accel / RECORDER_ACCEL_SCALE);
+    s.gyroMrads = toQ16(imu.gyro / RECORDER_GYRO_SCALE);
+    return s;
+}
+
+void packRecorderSampleQ(RecorderSample_t* out, uint32_t tMs, int rawWater,
+                         const ImuRaw_t& imu, const RecorderScaleQ_t& scale) {
+    out->tMs = tMs;
+    for (int k = 0; k < 3; k++) {
+        out->accel[k] = sat16(mulQ16(imu.accel[k], scale.accelCms));
+        out->gyro[k] = sat16(mulQ16(imu.gyro[k], scale.gyroMrads));
+    }
+    out->water = (uint16_t)rawWater;
+}
+
+void buildChannelsQ(int32_t* channels, q15_t water, const ImuRaw_t& imu,
+                    const DerivedLevels_t& derived) {
+    channels[CH_WATER] = water;
+    channels[CH_ACCEL_X] = imu.accel[0];
+    channels[CH_ACCEL_Y] = imu.accel[1];
+    channels[CH_ACCEL_Z] = imu.accel[2];
+    channels[CH_GYRO_X] = imu.gyro[0];
+    channels[CH_GYRO_Y] = imu.gyro[1];
+    channels[CH_GYRO_Z] = imu.gyro[2];
+    channels[CH_GYRO_XY] = iabs32(imu.gyro[0]) + iabs32(imu.gyro[1]);
+
+    // Three squares of int16 fit in uint32 (3 * 2^30)
+    uint32_t sq = 0;
+    for (int k = 0; k < 3; k++) sq += (uint32_t)((int32_t)imu.accel[k] * imu.accel[k]);
+    channels[CH_ACCEL_MAG] = (int32_t)isqrt32(sq);
+    channels[CH_VIB_QUAKE] = derived.vibQuake;
+    channels[CH_PGA] = derived.pga;
+    channels[CH_MMI] = derived.mmi;
+    channels[CH_WATER_RISE] = derived.waterRise;
+    channels[CH_WATER_ETA] = derived.waterEta;
+}
+
+void sensorChannelScales(const ImuScale_t& imu, float* unitsPerLsb) {
+    unitsPerLsb[CH_WATER] = 100.0f / Q15_ONE;
+    unitsPerLsb[CH_ACCEL_X] = imu.accel;
+    unitsPerLsb[CH_ACCEL_Y] = imu.accel;
+    unitsPerLsb[CH_ACCEL_Z] = imu.accel;
+    unitsPerLsb[CH_GYRO_X] = imu.gyro;
+    unitsPerLsb[CH_GYRO_Y] = imu.gyro;
+    unitsPerLsb[CH_GYRO_Z] = imu.gyro;
+    unitsPerLsb[CH_GYRO_XY] = imu.gyro;
+    unitsPerLsb[CH_ACCEL_MAG] = imu.accel;
+    unitsPerLsb[CH_VIB_QUAKE] = imu.accel;
+    unitsPerLsb[CH_PGA] = imu.accel;
+    unitsPerLsb[CH_MMI] = 0.1f;
+    unitsPerLsb[CH_WATER_RISE] = 100.0f / Q15_ONE;
+    unitsPerLsb[CH_WATER_ETA] = 1.0f;
+}
+
+float waterPercentFromQ15(q15_t water) {
+    return water * (100.0f / Q15_ONE);
+}
+
+// ============================================================================
+// FLOAT REFERENCE PATH
+// ============================================================================
+
+float waterPercentFromRaw(int raw) {
+    return (raw / 4095.0) * 100.0;
+}
+
+float waterPercentFromRawF(int raw) {
+    // No double literal, so no soft-float routines
+    return raw * (100.0f / WATER_ADC_MAX);
+}
+
+static inline int16_t saturate16(float v) {
+    if (v > 32767.0f) return 32767;
+    if (v < -32767.0f) return -32767;
+    return (int16_t)v;
+}
+
+void packRecorderSample(RecorderSample_t* out, uint32_t tMs, int rawWater,
+                        const float accel[3], const float gyro[3]) {
+    out->tMs = tMs;
+    for (int k = 0; k < 3; k++) {
+        out->accel[k] = saturate16(accel[k] * 100.0f);
+        out->gyro[k] = saturate16(gyro[k] * 1000.0f);
+    }
+    out->water = (uint16_t)rawWater;
+}
+
+void buildChannels(float* channels, float waterPercent,
+                   const float accel[3], const float gyro[3]) {
+    channels[CH_WATER] = waterPercent;
+    channels[CH_ACCEL_X] = accel[0];
+    channels[CH_ACCEL_Y] = accel[1];
+    channels[CH_ACCEL_Z] = accel[2];
+    channels[CH_GYRO_X] = gyro[0];
+    channels[CH_GYRO_Y] = gyro[1];
+    channels[CH_GYRO_Z] = gyro[2];
+    channels[CH_GYRO_XY] = fabsf(gyro[0]) + fabsf(gyro[1]);
+    channels[CH_ACCEL_MAG] = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+    channels[CH_VIB_QUAKE] = 0.0f;     // Windowed, not part of the per-sample path
+    channels[CH_PGA] = 0.0f;
+    channels[CH_MMI] = 1.0f;
+    channels[CH_WATER_RISE] = 0.0f;
+    channels[CH_WATER_ETA] = WATER_TREND_ETA_NONE_S;
+}
@@ -0,0 +1,88 @@
+/**
+ * MOD-EVAC-MS - Sensor Conversion
+ * Raw readings to the representations used by the rules engine, the
+ * flight recorder and telemetry. Kept free of Arduino so the same code
+ * is benchmarked natively.
+ *
+ * The acquisition path is fixed point end to end: water is Q15 of ADC
+ * full scale, IMU channels stay in sensor counts (Q15 of the configured
+ * range), and recorder units come from precomputed Q16 multipliers.
+ * Engineering units (%, m/s^2, rad/s) appear only at the host boundary,
+ * via the per-channel scales from sensorChannelScales(). The float
+ * functions at the end are the previous path, kept as the benchmark
+ * reference.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "fixed_point.h"
+#include "flight_recorder.h"
+#include "mpu6050.h"
+#include "rules_engine.h"
+#include "water_trend.h"
+
+#define WATER_ADC_MAX       4095    // 12-bit ADC full scale
+
+// Counts to recorder units (cm/s^2, mrad/s), Q16
+typedef struct {
+    int32_t accelCms;
+    int32_t gyroMrads;
+} RecorderScaleQ_t;
+
+// ============================================================================
+// FIXED-POINT PATH (sensorTask)
+// ============================================================================
+
+// 0-4095 ADC counts to Q15 of full scale (4095 -> Q15_ONE)
+q15_t waterQ15FromRaw(int raw);
+
+RecorderScaleQ_t recorderScaleQ(const ImuScale_t& imu);
+
+// Compact recorder sample straight from counts
+void packRecorderSampleQ(RecorderSample_t* out, uint32_t tMs, int rawWater,
+                         const ImuRaw_t& imu, const RecorderScaleQ_t& scale);
+
+// Levels from the windowed analyzers, held between their updates
+// (channel LSBs)
+typedef struct {
+    int32_t vibQuake;       // Quake-band RMS (vibration_fft.h), accel counts
+    int32_t pga;            // Peak ground acceleration (ground_motion.h), accel counts
+    int32_t mmi;            // Intensity, tenths of MMI
+    int32_t waterRise;      // Rate of rise (water_trend.h), Q15 per minute
+    int32_t waterEta;       // Seconds to the water danger threshold
+} DerivedLevels_t;
+
+// Values before the analyzers have produced anything (no shaking, MMI I,
+// water flat)
+extern const DerivedLevels_t DERIVED_LEVELS_IDLE;
+
+// Channel vector for RulesEngine::evaluate, in channel LSBs
+void buildChannelsQ(int32_t* channels, q15_t water, const ImuRaw_t& imu,
+                    const DerivedLevels_t& derived);
+
+// Engineering units per channel LSB (% or m/s^2 or rad/s), NUM_CHANNELS entries
+void sensorChannelScales(const ImuScale_t& imu, float* unitsPerLsb);
+
+// Q15 water back to % (host boundary)
+float waterPercentFromQ15(q15_t water);
+
+// ============================================================================
+// FLOAT REFERENCE PATH (benchmarks)
+// ============================================================================
+
+// 0-4095 ADC counts to water level %: the original double-promoting
+// expression, the baseline the Q15 path is measured against
+float waterPercentFromRaw(int raw);
+
+// Same in single precision
+float waterPercentFromRawF(int raw);
+
+// Compact recorder sample (cm/s^2, mrad/s, raw ADC) from SI readings
+void packRecorderSample(RecorderSample_t* out, uint32_t tMs, int rawWater,
+                        const float accel[3], const float gyro[3]);
+
+// Engineering-unit channel vector
+void buildChannels(float* channels, float waterPercent,
+                   const float accel[3], const float gyro[3]);
@@ -0,0 +1,61 @@
+/**
+ * MOD-EVAC-MS - Per-sample Sensor Pipeline
+ */
+
+#include "sensor_pipeline.h"
+
+// AlertState_t levels (app.cpp)
+static const uint8_t LEVEL_DANGER = 3;
+static const uint8_t LEVEL_EVACUATE = 4;
+
+void SensorPipeline::begin(float sampleHz, const ImuScale_t& scale) {
+    _scale = scale;
+    _vibration.begin(sampleHz, scale.accel);
+    _ground.begin(sampleHz, scale.accel);
+    _water.begin(sampleHz);
+    _derived = DERIVED_LEVELS_IDLE;
+}
+
+PipelineEvents_t SensorPipeline::process(q15_t water, const ImuRaw_t& imu, uint32_t tMs, int32_t* channels) {
+    PipelineEvents_t ev = {};
+
+    // Spectrum of the three axes every VIB_FFT_HOP samples
+    ev.vibReady = _vibration.push(imu, tMs);
+    if (ev.vibReady) {
+        _vibration.analyze(&_spectrum);
+        _derived.vibQuake = (int32_t)(vibQuakeLevel(_spectrum) / _scale.accel + 0.5f);
+    }
+
+    // PGA/PGV and intensity, refreshed once a second. The MMI channel is
+    // the bucket's own, so rule hold times see how long shaking lasts.
+    ev.groundReady = _ground.push(imu, tMs);
+    if (ev.groundReady) {
+        const GroundMotion_t& gm = _ground.current();
+        _derived.pga = (int32_t)(gm.pga / (100.0f * _scale.accel) + 0.5f);
+        _derived.mmi = (int32_t)(gm.bucketMmi * 10.0f + 0.5f);
+        ev.intensityChanged = _ground.takeLevelChange();
+    }
+
+    // Water rate of rise, one fitted point a second
+    ev.waterFitted = _water.push(water, tMs);
+    if (ev.waterFitted) {
+        _derived.waterRise = _water.rateLsb();
+        _derived.waterEta = _water.current().etaS;
+        ev.waterRisingChanged = _water.takeRisingChange();
+    }
+
+    buildChannelsQ(channels, water, imu, _derived);
+    return ev;
+}
+
+uint8_t escalateAlert(RulesEngine& rules, const LinkWatchdog& watchdog,
+                      const int32_t* channels, uint32_t tMs, uint8_t currentAlert) {
+    uint8_t alert = rules.evaluate(channels, tMs);
+
+    // Failsafe: with no host to oversee, anything at DANGER or above
+    // becomes an evacuation
+    if (watchdog.failover() && (alert >= LEVEL_DANGER || currentAlert >= LEVEL_DANGER)) {
+        alert = LEVEL_EVACUATE;
+    }
+    return alert > currentAlert ? alert : currentAlert;
+}
@@ -0,0 +1,65 @@
+/**
+ * MOD-EVAC-MS - Per-sample Sensor Pipeline
+ * The one step every acquired sample goes through, shared by the sensor
+ * task and the offline replay so a replay runs the device's code rather
+ * than a copy of it.
+ *
+ * process() takes the Q15 water level and IMU counts, pushes them through
+ * the vibration, ground-motion and water-trend analyzers and fills the
+ * rules engine's channel vector (derived levels held between analyzer
+ * updates). escalate() evaluates the rules on that vector and applies the
+ * failsafe promotion. State shared with other tasks (recorder, stats,
+ * reporting hand-offs) stays with the caller.
+ * Pure C++, no Arduino dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "ground_motion.h"
+#include "link_watchdog.h"
+#include "mpu6050.h"
+#include "rules_engine.h"
+#include "sensor_convert.h"
+#include "vibration_fft.h"
+#include "water_trend.h"
+
+// What one sample produced besides the channel vector
+typedef struct {
+    bool vibReady;              // spectrum() is a fresh analysis window
+    bool groundReady;           // ground() closed a one-second bucket
+    bool intensityChanged;      // Reported intensity level changed
+    bool waterFitted;           // water() has a fresh fitted point
+    bool waterRisingChanged;    // Rising flag flipped
+} PipelineEvents_t;
+
+class SensorPipeline {
+public:
+    void begin(float sampleHz, const ImuScale_t& scale);
+
+    // Water level the time-to-threshold is predicted against (Q15)
+    void setWaterThreshold(int32_t q15) { _water.setThreshold(q15); }
+
+    // One sample through the analyzers; `channels` gets NUM_CHANNELS LSBs
+    PipelineEvents_t process(q15_t water, const ImuRaw_t& imu, uint32_t tMs, int32_t* channels);
+
+    const VibSpectrum_t& spectrum() const { return _spectrum; }
+    const GroundMotion_t& ground() const { return _ground.current(); }
+    const WaterTrend_t& water() const { return _water.current(); }
+
+private:
+    ImuScale_t _scale = { 1.0f, 1.0f };
+    VibrationAnalyzer _vibration;
+    VibSpectrum_t _spectrum = {};
+    GroundMotion _ground;
+    WaterTrend _water;
+    DerivedLevels_t _derived = DERIVED_LEVELS_IDLE;
+};
+
+// Alert level the controller should be at after this sample (AlertState_t):
+// the highest active rule, or EVACUATE in failsafe mode once the rules or
+// currentAlert reach DANGER. Never lower than currentAlert; the host stays
+// in charge of clearing alerts.
+uint8_t escalateAlert(RulesEngine& rules, const LinkWatchdog& watchdog,
+                      const int32_t* channels, uint32_t tMs, uint8_t currentAlert);
@@ -0,0 +1,31 @@
+/**
+ * MOD-EVAC-MS - Telemetry Encoding
+ */
+
+#include "telemetry.h"
+
+#include <ArduinoJson.h>
+
+size_t encodeTelemetry(const TelemetrySnapshot_t& t, char* out, size_t cap) {
+    StaticJsonDocument<320> doc;
+    doc["type"] = "telemetry";
+    doc["water"] = t.water;
+
+    JsonObject gyro = doc.createNestedObject("gyro");
+    gyro["x"] = t.gyro[0];
+    gyro["y"] = t.gyro[1];
+    gyro["z"] = t.gyro[2];
+
+    JsonObject accel = doc.createNestedObject("accel");
+    accel["x"] = t.accel[0];
+    accel["y"] = t.accel[1];
+    accel["z"] = t.accel[2];
+
+    doc["alert"] = t.alert;
+    doc["imu_ok"] = t.imuOk;
+    doc["imu_err"] = t.imuErrors;
+    doc["ts"] = t.ts;
+
+    size_t len = serializeJson(doc, out, cap);
+    return (len < cap) ? len : 0;
+}
@@ -0,0 +1,25 @@
+/**
+ * MOD-EVAC-MS - Telemetry Encoding
+ * Builds the 10Hz "telemetry" JSON line from a snapshot taken under the
+ * sensor mutex, so serialisation happens outside the lock.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TELEMETRY_MAX_LEN   320
+
+typedef struct {
+    float water;            // %
+    float gyro[3];          // rad/s
+    float accel[3];         // m/s^2
+    uint8_t alert;          // AlertState_t
+    bool imuOk;             // IMU online (false = values held while re-probing)
+    uint32_t imuErrors;     // IMU I2C errors since boot
+    uint32_t ts;            // millis()
+} TelemetrySnapshot_t;
+
+// Writes the JSON object (no newline) into out. Returns its length, 0 on overflow.
+size_t encodeTelemetry(const TelemetrySnapshot_t& t, char* out, size_t cap);
@@ -0,0 +1,180 @@
+/**
+ * MOD-EVAC-MS - Vibration Spectrum Analysis
+ */
+
+#include "vibration_fft.h"
+
+#include <math.h>
+
+#if defined(ARDUINO_ARCH_ESP32) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define VIB_USE_ESP_DSP 1
+#endif
+
+#define TWO_PI_F            6.28318531f
+
+const float VIB_BAND_EDGES_HZ[VIB_BANDS + 1] = { 0.4f, 1.0f, 10.0f, 1000.0f };
+
+// ============================================================================
+// FFT
+// ============================================================================
+
+#ifdef VIB_USE_ESP_DSP
+void vibFft(float* data, uint16_t n, const float*) {
+    dsps_fft2r_fc32(data, n);
+    dsps_bit_rev_fc32(data, n);
+}
+#else
+static void bitReverse(float* d, uint16_t n) {
+    for (uint16_t i = 1, j = 0; i < n; i++) {
+        uint16_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float t = d[2 * i]; d[2 * i] = d[2 * j]; d[2 * j] = t;
+            t = d[2 * i + 1]; d[2 * i + 1] = d[2 * j + 1]; d[2 * j + 1] = t;
+        }
+    }
+}
+
+// Iterative decimation in time; twiddle[2k], twiddle[2k+1] = cos, -sin(2 pi k / n)
+void vibFft(float* data, uint16_t n, const float* twiddle) {
+    bitReverse(data, n);
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        uint16_t half = len >> 1;
+        uint16_t step = n / len;
+        for (uint16_t i = 0; i < n; i += len) {
+            for (uint16_t k = 0; k < half; k++) {
+                float wr = twiddle[2 * k * step];
+                float wi = twiddle[2 * k * step + 1];
+                float* a = &data[2 * (i + k)];
+                float* b = &data[2 * (i + k + half)];
+                float xr = b[0] * wr - b[1] * wi;
+                float xi = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - xr;
+                b[1] = a[1] - xi;
+                a[0] += xr;
+                a[1] += xi;
+            }
+        }
+    }
+}
+#endif
+
+// ============================================================================
+// ANALYZER
+// ============================================================================
+
+float vibQuakeLevel(const VibSpectrum_t& s) {
+    if (s.quakeRatio < VIB_QUAKE_RATIO_MIN || s.crest >= VIB_CREST_IMPULSIVE) return 0.0f;
+    return s.bandRms[VIB_BAND_QUAKE];
+}
+
+void VibrationAnalyzer::begin(float sampleHz, float unitsPerLsb) {
+    _sampleHz = sampleHz;
+    _scale = unitsPerLsb;
+    _head = 0;
+    _filled = 0;
+    _sinceHop = 0;
+
+    _windowPower = 0.0f;
+    for (uint16_t i = 0; i < VIB_FFT_N; i++) {
+        _window[i] = 0.5f - 0.5f * cosf(TWO_PI_F * i / VIB_FFT_N);
+        _windowPower += _window[i] * _window[i];
+    }
+    for (uint16_t k = 0; k < VIB_FFT_N / 2; k++) {
+        _twiddle[2 * k] = cosf(TWO_PI_F * k / VIB_FFT_N);
+        _twiddle[2 * k + 1] = -sinf(TWO_PI_F * k / VIB_FFT_N);
+    }
+#ifdef VIB_USE_ESP_DSP
+    dsps_fft2r_init_fc32(NULL, VIB_FFT_N);
+#endif
+}
+
+bool VibrationAnalyzer::push(const ImuRaw_t& imu, uint32_t tMs) {
+    for (int k = 0; k < 3; k++) _ring[k][_head] = imu.accel[k];
+    _head = (_head + 1) % VIB_FFT_N;
+    _lastMs = tMs;
+    if (_filled < VIB_FFT_N) _filled++;
+    if (++_sinceHop < VIB_FFT_HOP || _filled < VIB_FFT_N) return false;
+    _sinceHop = 0;
+    return true;
+}
+
+void VibrationAnalyzer::analyze(VibSpectrum_t* out) {
+    // Mean removal per axis takes out gravity and offsets
+    float mean[3];
+    for (int k = 0; k < 3; k++) {
+        int32_t sum = 0;
+        for (uint16_t i = 0; i < VIB_FFT_N; i++) sum += _ring[k][i];
+        mean[k] = (float)sum / VIB_FFT_N;
+    }
+
+    // Crest factor of the dynamic vector, oldest sample first
+    float peakSq = 0.0f, sumSq = 0.0f;
+    for (uint16_t i = 0; i < VIB_FFT_N; i++) {
+        uint16_t j = (_head + i) % VIB_FFT_N;
+        float m2 = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            float x = (_ring[k][j] - mean[k]) * _scale;
+            m2 += x * x;
+        }
+        if (m2 > peakSq) peakSq = m2;
+        sumSq += m2;
+    }
+
+    // One-sided power per bin as mean-square contribution (Parseval with
+    // the window's power), summed over the axes; the Nyquist bin is left out
+    const float norm = 2.0f / (VIB_FFT_N * _windowPower);
+    for (uint16_t k = 1; k < VIB_FFT_N / 2; k++) _power[k] = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        for (uint16_t i = 0; i < VIB_FFT_N; i++) {
+            float x = (_ring[axis][(_head + i) % VIB_FFT_N] - mean[axis]) * _scale;
+            _data[2 * i] = x * _window[i];
+            _data[2 * i + 1] = 0.0f;
+        }
+        vibFft(_data, VIB_FFT_N, _twiddle);
+        for (uint16_t k = 1; k < VIB_FFT_N / 2; k++) {
+            _power[k] += (_data[2 * k] * _data[2 * k] + _data[2 * k + 1] * _data[2 * k + 1]) * norm;
+        }
+    }
+
+    const float binHz = _sampleHz / VIB_FFT_N;
+    float band[VIB_BANDS] = { 0 };
+    float total = 0.0f;
+    float best = 0.0f, prev = 0.0f;
+    float bestPrev = 0.0f, bestNext = 0.0f;
+    uint16_t bestBin = 0;
+    for (uint16_t k = 1; k < VIB_FFT_N / 2; k++) {
+        float p = _power[k];
+        float f = k * binHz;
+        total += p;
+        for (uint8_t b = 0; b < VIB_BANDS; b++) {
+            if (f >= VIB_BAND_EDGES_HZ[b] && f < VIB_BAND_EDGES_HZ[b + 1]) band[b] += p;
+        }
+        if (k == bestBin + 1) bestNext = p;
+        if (p > best) {
+            best = p;
+            bestBin = k;
+            bestPrev = prev;
+            bestNext = 0.0f;
+        }
+        prev = p;
+    }
+
+    out->tMs = _lastMs;
+    for (uint8_t b = 0; b < VIB_BANDS; b++) out->bandRms[b] = sqrtf(band[b]);
+    out->totalRms = sqrtf(total);
+    out->quakeRatio = (total > 0.0f) ? band[VIB_BAND_QUAKE] / total : 0.0f;
+
+    // Parabolic interpolation between neighbouring bins; a Hann-windowed
+    // tone spreads over the peak and its neighbours
+    float delta = 0.0f;
+    float denom = bestPrev - 2.0f * best + bestNext;
+    if (bestBin > 1 && denom < 0.0f) delta = 0.5f * (bestPrev - bestNext) / denom;
+    out->dominantHz = (bestBin + delta) * binHz;
+    out->dominantRms = sqrtf(bestPrev + best + bestNext);
+
+    float rms = sqrtf(sumSq / VIB_FFT_N);
+    out->crest = (rms > 0.0f) ? sqrtf(peakSq) / rms : 0.0f;
+}
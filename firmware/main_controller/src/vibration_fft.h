@@ -0,0 +1,89 @@
+/**
+ * MOD-EVAC-MS - Vibration Spectrum Analysis
+ * Windowed radix-2 FFT of the three acceleration axes, reduced to band
+ * RMS values, the dominant frequency and a crest factor so ground motion
+ * (energy concentrated in ~1-10 Hz, sustained) can be told apart from
+ * footfall and door slams (impulsive, broadband, high crest).
+ *
+ * Each axis has its window mean (gravity, offsets) removed and is
+ * transformed on its own; the power spectra are summed. That is the
+ * spectrum of the dynamic acceleration vector whatever the board's
+ * orientation. |a| would not do: horizontal shaking changes it only to
+ * second order and at twice the shaking frequency.
+ *
+ * push() takes one sample per sensor period and is O(1); every
+ * VIB_FFT_HOP samples a VIB_FFT_N window (50 % overlap) is ready and
+ * analyze() runs the three FFTs. The transform is single-precision float: it
+ * runs once per window, the ESP32 FPU handles it, and a scaled Q15 FFT
+ * would round footfall-level signals (tens of counts) away. With ESP-DSP
+ * available the ESP32 build uses its optimised dsps_fft2r_fc32; otherwise
+ * (and natively) a portable iterative FFT. No Arduino dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "mpu6050.h"
+
+#define VIB_FFT_N           128     // 2.56 s at 50 Hz, 0.39 Hz bins
+#define VIB_FFT_HOP         64      // New window every 1.28 s
+
+// Band edges (Hz). The MPU DLPF (21 Hz) is the anti-alias filter at 50 Hz.
+typedef enum {
+    VIB_BAND_LOW = 0,       // 0.4-1 Hz: building sway, drift
+    VIB_BAND_QUAKE,         // 1-10 Hz: body waves at structural frequencies
+    VIB_BAND_HIGH,          // 10 Hz-Nyquist: footfall, machinery, impacts
+    VIB_BANDS
+} VibBand_t;
+
+extern const float VIB_BAND_EDGES_HZ[VIB_BANDS + 1];
+
+// A window counts as ground motion only when the quake band holds most of
+// the energy and it is not impulsive (footfall crest factors run 4+)
+#define VIB_QUAKE_RATIO_MIN     0.5f
+#define VIB_CREST_IMPULSIVE     4.0f
+
+typedef struct {
+    uint32_t tMs;                   // Timestamp of the newest sample
+    float bandRms[VIB_BANDS];       // m/s^2
+    float totalRms;                 // m/s^2, DC removed
+    float dominantHz;               // Interpolated peak bin
+    float dominantRms;              // m/s^2 at the peak
+    float quakeRatio;               // Quake-band share of total energy, 0-1
+    float crest;                    // Peak / RMS of the vector in the time domain
+} VibSpectrum_t;
+
+class VibrationAnalyzer {
+public:
+    void begin(float sampleHz, float unitsPerLsb);
+
+    // One IMU sample (accel counts). Returns true when a window is ready
+    // for analyze().
+    bool push(const ImuRaw_t& imu, uint32_t tMs);
+
+    void analyze(VibSpectrum_t* out);
+
+private:
+    float _sampleHz = 50.0f;
+    float _scale = 1.0f;
+    int16_t _ring[3][VIB_FFT_N];
+    uint16_t _head = 0;
+    uint16_t _filled = 0;
+    uint16_t _sinceHop = 0;
+    uint32_t _lastMs = 0;
+
+    float _window[VIB_FFT_N];       // Hann
+    float _windowPower = 1.0f;      // Sum of w^2
+    float _twiddle[VIB_FFT_N];      // cos, -sin pairs for k < N/2
+    float _data[2 * VIB_FFT_N];     // Interleaved complex work buffer, one axis
+    float _power[VIB_FFT_N / 2];    // Summed over the axes
+};
+
+// Quake-band RMS (m/s^2) when the window looks like ground motion, else 0.
+// Feeds the CH_VIB_QUAKE rule channel.
+float vibQuakeLevel(const VibSpectrum_t& s);
+
+// In-place forward FFT of `n` interleaved complex values (n a power of
+// two). Exposed for the benchmark.
+void vibFft(float* data, uint16_t n, const float* twiddle);
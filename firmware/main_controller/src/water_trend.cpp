@@ -0,0 +1,90 @@
+/**
+ * MOD-EVAC-MS - Water Rate of Rise
+ */
+
+#include "water_trend.h"
+
+#define POINTS_PER_MIN      (60000.0f / WATER_TREND_POINT_MS)
+
+void WaterTrend::begin(float sampleHz) {
+    _pointSamples = (uint16_t)(sampleHz * WATER_TREND_POINT_MS / 1000.0f + 0.5f);
+    if (_pointSamples == 0) _pointSamples = 1;
+    _inPoint = 0;
+    _pointSum = 0;
+    _head = 0;
+    _n = 0;
+    _sumY = 0;
+    _sumIY = 0;
+    _rateLsb = 0;
+    _trend = { 0, 0.0f, 0.0f, WATER_TREND_ETA_NONE_S, false, 0 };
+    _risingChanged = false;
+}
+
+bool WaterTrend::push(q15_t water, uint32_t tMs) {
+    _pointSum += water;
+    if (++_inPoint < _pointSamples) return false;
+
+    int32_t y = (_pointSum + _pointSamples / 2) / _pointSamples;
+    _pointSum = 0;
+    _inPoint = 0;
+
+    if (_n < WATER_TREND_POINTS) {
+        _ring[(_head + _n) % WATER_TREND_POINTS] = y;
+        _sumIY += (int64_t)_n * y;
+        _sumY += y;
+        _n++;
+    } else {
+        // Dropping the oldest point shifts every index down by one:
+        // sum(i * y) loses sum(y) - y_oldest, the new point enters at N - 1
+        int32_t oldest = _ring[_head];
+        _sumIY += (int64_t)(WATER_TREND_POINTS - 1) * y - (_sumY - oldest);
+        _sumY += y - oldest;
+        _ring[_head] = y;
+        _head = (_head + 1) % WATER_TREND_POINTS;
+    }
+
+    fit(tMs);
+    return true;
+}
+
+void WaterTrend::fit(uint32_t tMs) {
+    bool wasRising = _trend.rising;
+    int64_t n = _n;
+
+    _trend.tMs = tMs;
+    _trend.points = _n;
+    if (_n < WATER_TREND_MIN_POINTS) {
+        _rateLsb = 0;
+        _trend.level = (_n > 0) ? (float)_sumY / n * (100.0f / Q15_ONE) : 0.0f;
+        _trend.ratePctMin = 0.0f;
+        _trend.etaS = WATER_TREND_ETA_NONE_S;
+        _trend.rising = false;
+    } else {
+        // Closed-form sums of i and i^2 over 0..n-1
+        int64_t sumI = n * (n - 1) / 2;
+        int64_t sumII = (n - 1) * n * (2 * n - 1) / 6;
+        int64_t num = n * _sumIY - sumI * _sumY;
+        int64_t den = n * sumII - sumI * sumI;
+
+        float slope = (float)num / (float)den;      // Q15 per point
+        float fitted = (float)_sumY / n + slope * (n - 1) * 0.5f;
+        float perMin = slope * POINTS_PER_MIN;
+
+        _rateLsb = (int32_t)(perMin + (perMin >= 0.0f ? 0.5f : -0.5f));
+        _trend.level = fitted * (100.0f / Q15_ONE);
+        _trend.ratePctMin = perMin * (100.0f / Q15_ONE);
+        _trend.rising = _trend.ratePctMin >= WATER_RISE_MIN_PCT_MIN;
+
+        _trend.etaS = WATER_TREND_ETA_NONE_S;
+        if (_threshold >= 0) {
+            if (fitted >= _threshold) {
+                _trend.etaS = 0;
+            } else if (_trend.rising) {
+                float eta = (_threshold - fitted) / slope * (WATER_TREND_POINT_MS / 1000.0f);
+                if (eta < WATER_TREND_ETA_NONE_S) _trend.etaS = (int32_t)(eta + 0.5f);
+            }
+        }
+    }
+
+    if (_trend.rising != wasRising) _risingChanged = true;
+}
@@ -0,0 +1,72 @@
+/**
+ * MOD-EVAC-MS - Water Rate of Rise
+ * Rolling least-squares slope of the water level and the time left until
+ * it reaches the danger threshold, so flood warnings can fire while the
+ * water is still rising instead of once it is already high.
+ *
+ * Samples are boxcar-averaged into one point per WATER_TREND_POINT_MS
+ * (the filtering: it removes ADC noise and ripple). The regression over
+ * the last WATER_TREND_POINTS points keeps integer running sums of y and
+ * i * y that are updated in O(1) per point as the window slides, so the
+ * fit is exact with no accumulated drift; only the final slope and ETA
+ * are computed in float, once per point. Pure C++, no Arduino dependency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "fixed_point.h"
+
+#define WATER_TREND_POINT_MS        1000    // One fitted point per second
+#define WATER_TREND_POINTS          120     // Regression window (2 min)
+#define WATER_TREND_MIN_POINTS      20      // No estimate before this much history
+#define WATER_TREND_ETA_NONE_S      86400   // Not rising toward the threshold
+#define WATER_RISE_MIN_PCT_MIN      0.5f    // Slower than this counts as flat
+
+typedef struct {
+    uint32_t tMs;               // Newest point
+    float level;                // Fitted level at the newest point, %
+    float ratePctMin;           // %/min, negative when falling
+    int32_t etaS;               // Seconds to the danger threshold, or WATER_TREND_ETA_NONE_S
+    bool rising;                // Rate above WATER_RISE_MIN_PCT_MIN
+    uint16_t points;            // Points in the fit
+} WaterTrend_t;
+
+class WaterTrend {
+public:
+    void begin(float sampleHz);
+
+    // Danger level (Q15 of ADC full scale); negative disables the ETA
+    void setThreshold(int32_t dangerQ15) { _threshold = dangerQ15; }
+
+    // One water sample. Returns true when a point closed and current()
+    // holds a fresh estimate.
+    bool push(q15_t water, uint32_t tMs);
+
+    const WaterTrend_t& current() const { return _trend; }
+
+    // Rise rate in Q15 of full scale per minute (CH_WATER_RISE)
+    int32_t rateLsb() const { return _rateLsb; }
+
+    // One-shot: the rising flag changed
+    bool takeRisingChange() { bool v = _risingChanged; _risingChanged = false; return v; }
+
+private:
+    void fit(uint32_t tMs);
+
+    uint16_t _pointSamples = 50;
+    uint16_t _inPoint = 0;
+    int32_t _pointSum = 0;
+    int32_t _threshold = -1;
+
+    int32_t _ring[WATER_TREND_POINTS];
+    uint16_t _head = 0;             // Oldest point once the window is full
+    uint16_t _n = 0;
+    int64_t _sumY = 0;              // Sum of y_i
+    int64_t _sumIY = 0;             // Sum of i * y_i, i = 0 for the oldest point
+
+    int32_t _rateLsb = 0;
+    WaterTrend_t _trend = { 0, 0.0f, 0.0f, WATER_TREND_ETA_NONE_S, false, 0 };
+    bool _risingChanged = false;
+};
@@ -0,0 +1,94 @@
+/**
+ * MOD-EVAC-MS - GSM call under DANGER vs the host link watchdog
+ * Runs the controller application through hal_posix.cpp with the host link
+ * and GSM UART on pipes. The backend raises DANGER, asks for an emergency
+ * call and keeps pinging: the 30 s ring must not stall the serial task, so
+ * the watchdog never fails over and the alert is not latched to EVACUATE.
+ *
+ *   pio test -e native_test
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <unity.h>
+
+#include "../../src/app.h"
+#include "../../src/hal/hal_posix.h"
+
+#define SIM_SPEED       20.0
+#define PING_PERIOD_MS  5000    // Backend ping rate (control_worker.py)
+#define RUN_MS          40000   // Past the ring time and two link timeouts
+
+static int hostIn[2], hostOut[2], gsmOut[2];
+static std::string hostLog, gsmLog;
+
+static void drain(int fd, std::string& into) {
+    char buf[512];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) into.append(buf, (size_t)n);
+}
+
+static void sendHost(const char* line) {
+    TEST_ASSERT_EQUAL((ssize_t)strlen(line), write(hostIn[1], line, strlen(line)));
+}
+
+// Sleep in virtual time while keeping the app's output pipes empty
+static void runFor(uint32_t ms) {
+    uint32_t start = halMillis();
+    while (halMillis() - start < ms) {
+        halDelayMs(50);
+        drain(hostOut[0], hostLog);
+        drain(gsmOut[0], gsmLog);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_gsm_call_under_danger_keeps_link() {
+    sendHost("{\"cmd\":\"set_alert\",\"alert\":3}\n");
+    runFor(200);
+    sendHost("{\"cmd\":\"gsm_call\",\"number\":\"+15550100\"}\n");
+
+    for (uint32_t t = 0; t < RUN_MS; t += PING_PERIOD_MS) {
+        runFor(PING_PERIOD_MS);
+        sendHost("{\"cmd\":\"ping\"}\n");
+    }
+    runFor(200);
+
+    TEST_ASSERT_TRUE(hostLog.find("\"event\":\"alert_set\",\"alert\":3") != std::string::npos);
+    TEST_ASSERT_TRUE(hostLog.find("\"event\":\"gsm_dialing\"") != std::string::npos);
+    TEST_ASSERT_TRUE(hostLog.find("\"event\":\"gsm_hangup\"") != std::string::npos);
+    TEST_ASSERT_TRUE(hostLog.find("\"event\":\"link_lost\"") == std::string::npos);
+    TEST_ASSERT_TRUE(hostLog.find("\"alert\":4") == std::string::npos);
+    TEST_ASSERT_TRUE(gsmLog.find("ATD+15550100;") != std::string::npos);
+    TEST_ASSERT_TRUE(gsmLog.find("ATH") != std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    if (pipe(hostIn) || pipe(hostOut) || pipe(gsmOut)) return 1;
+    fcntl(hostOut[0], F_SETFL, O_NONBLOCK);
+    fcntl(gsmOut[0], F_SETFL, O_NONBLOCK);
+
+    HalPosixConfig_t config = {};
+    config.speed = SIM_SPEED;
+    config.hostInFd = hostIn[0];
+    config.hostOutFd = hostOut[1];
+    config.gsmOutFd = gsmOut[1];
+    halPosixConfigure(config);
+    appSetup();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_gsm_call_under_danger_keeps_link);
+    int failures = UNITY_END();
+
+    // Tasks never return; skip static destructors while they are still running
+    fflush(stdout);
+    _exit(failures);
+}